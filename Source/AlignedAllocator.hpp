@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Definitions.hpp"
+
+/** Allocator returning storage aligned to a given boundary
+ *
+ * Used for arrays that are streamed through in the hot loops, so that vector loads never straddle
+ * a cache line. Drop-in replacement for std::allocator in the standard containers.
+ */
+template <class T, std::size_t Alignment = CACHE_LINE_SIZE>
+class AlignedAllocator {
+public:
+  using value_type = T;
+
+  template <class U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept = default;
+
+  template <class U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    if (n == 0) {
+      return NULL;
+    }
+    void* data = ::operator new(n * sizeof(T), std::align_val_t(Alignment));
+    return static_cast<T*>(data);
+  }
+
+  void deallocate(T* data, [[maybe_unused]] std::size_t n) noexcept {
+    ::operator delete(data, std::align_val_t(Alignment));
+  }
+
+  template <class U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+    return true;
+  }
+
+  template <class U>
+  bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept {
+    return false;
+  }
+};
+
+//! Contiguous array with cache-line aligned storage
+template <class T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
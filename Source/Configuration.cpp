@@ -75,6 +75,13 @@ void readStringMandatory(std::string& storage, tinyxml2::XMLElement* node) {
   }
 }
 
+void readStringOptional(std::string& storage, tinyxml2::XMLElement* node, const char* tag) {
+  const char* value = node->Attribute(tag);
+  if (value != NULL) {
+    storage = value;
+  }
+}
+
 void readWall(tinyxml2::XMLElement* wall, RealType* vector, RealType& scalar) {
   tinyxml2::XMLElement* quantity = wall->FirstChildElement("vector");
   if (quantity != NULL) {
@@ -309,6 +316,11 @@ void Configuration::loadParameters(Parameters& parameters, const MPI_Comm& commu
     readIntOptional(parameters.parallel.numProcessors[1], node, "numProcessorsY", 1);
     readIntOptional(parameters.parallel.numProcessors[2], node, "numProcessorsZ", 1);
 
+    readIntOptional(parameters.parallel.rebalanceInterval, node, "rebalanceInterval", 0);
+    readIntOptional(parameters.parallel.rebalanceAxes, node, "rebalanceAxes", 1);
+    readFloatOptional(parameters.parallel.particleCost, node, "particleCost", 1.0);
+    readFloatOptional(parameters.parallel.imbalanceThreshold, node, "imbalanceThreshold", 1.1);
+
     // Start neighbors on null in case that no parallel configuration is used later.
     parameters.parallel.leftNb   = MPI_PROC_NULL;
     parameters.parallel.rightNb  = MPI_PROC_NULL;
@@ -425,6 +437,18 @@ void Configuration::loadParameters(Parameters& parameters, const MPI_Comm& commu
       readIntMandatory(parameters.particles.particleCount, node, "particleCount");
       parameters.particles.injectInterval = parameters.simulation.finalTime + 1.0;
       readFloatOptional(parameters.particles.injectInterval, node, "injectInterval");
+      readIntOptional(parameters.particles.sortInterval, node, "sortInterval");
+      readIntOptional(parameters.particles.maxParticles, node, "maxParticles");
+      readBoolOptional(parameters.particles.dropOldest, node, "dropOldest");
+      readIntOptional(parameters.particles.integratorOrder, node, "integratorOrder", 1);
+      readFloatOptional(parameters.particles.cfl, node, "cfl");
+      readIntOptional(parameters.particles.trajectoryStride, node, "trajectoryStride");
+      readStringOptional(parameters.particles.deposit, node, "deposit");
+      readStringOptional(parameters.particles.statistics, node, "statistics");
+      readFloatOptional(parameters.particles.residenceBinWidth, node, "residenceBinWidth", 1.0);
+      readIntOptional(parameters.particles.residenceBins, node, "residenceBins", 20);
+      readIntOptional(parameters.particles.checkpointInterval, node, "checkpointInterval");
+      readStringOptional(parameters.particles.restart, node, "restart");
     }
   }
 
@@ -468,6 +492,10 @@ void Configuration::loadParameters(Parameters& parameters, const MPI_Comm& commu
   MPI_Bcast(&(parameters.bfStep.yRatio), 1, MY_MPI_FLOAT, 0, communicator);
 
   MPI_Bcast(parameters.parallel.numProcessors, 3, MPI_INT, 0, communicator);
+  MPI_Bcast(&(parameters.parallel.rebalanceInterval), 1, MPI_INT, 0, communicator);
+  MPI_Bcast(&(parameters.parallel.rebalanceAxes), 1, MPI_INT, 0, communicator);
+  MPI_Bcast(&(parameters.parallel.particleCost), 1, MY_MPI_FLOAT, 0, communicator);
+  MPI_Bcast(&(parameters.parallel.imbalanceThreshold), 1, MY_MPI_FLOAT, 0, communicator);
 
   MPI_Bcast(&(parameters.walls.scalarLeft), 1, MY_MPI_FLOAT, 0, communicator);
   MPI_Bcast(&(parameters.walls.scalarRight), 1, MY_MPI_FLOAT, 0, communicator);
@@ -489,4 +517,16 @@ void Configuration::loadParameters(Parameters& parameters, const MPI_Comm& commu
   MPI_Bcast(&(parameters.particles.enable), 1, MPI_C_BOOL, 0, communicator);
   MPI_Bcast(&(parameters.particles.particleCount), 1, MPI_INT, 0, communicator);
   MPI_Bcast(&(parameters.particles.injectInterval), 1, MY_MPI_FLOAT, 0, communicator);
+  MPI_Bcast(&(parameters.particles.sortInterval), 1, MPI_INT, 0, communicator);
+  MPI_Bcast(&(parameters.particles.maxParticles), 1, MPI_INT, 0, communicator);
+  MPI_Bcast(&(parameters.particles.dropOldest), 1, MPI_C_BOOL, 0, communicator);
+  MPI_Bcast(&(parameters.particles.integratorOrder), 1, MPI_INT, 0, communicator);
+  MPI_Bcast(&(parameters.particles.cfl), 1, MY_MPI_FLOAT, 0, communicator);
+  MPI_Bcast(&(parameters.particles.trajectoryStride), 1, MPI_INT, 0, communicator);
+  broadcastString(parameters.particles.deposit, communicator);
+  broadcastString(parameters.particles.statistics, communicator);
+  MPI_Bcast(&(parameters.particles.residenceBinWidth), 1, MY_MPI_FLOAT, 0, communicator);
+  MPI_Bcast(&(parameters.particles.residenceBins), 1, MPI_INT, 0, communicator);
+  MPI_Bcast(&(parameters.particles.checkpointInterval), 1, MPI_INT, 0, communicator);
+  broadcastString(parameters.particles.restart, communicator);
 }
@@ -14,8 +14,6 @@ ScalarField::ScalarField(int Nx, int Ny, int Nz):
   initialize();
 }
 
-RealType& ScalarField::getScalar(int i, int j, int k) { return data_[index2array(i, j, k)]; }
-
 void ScalarField::show(const std::string title) {
   std::cout << std::endl << "--- " << title << " ---" << std::endl;
   for (int k = 0; k < sizeZ_; k++) {
@@ -47,8 +45,6 @@ VectorField::VectorField(int Nx, int Ny, int Nz):
   initialize();
 }
 
-RealType* VectorField::getVector(int i, int j, int k) { return &data_[index2array(i, j, k)]; }
-
 void VectorField::show(const std::string title) {
   std::cout << std::endl << "--- " << title << " ---" << std::endl;
   std::cout << "Component 1" << std::endl;
@@ -98,8 +94,6 @@ void IntScalarField::initialize() {
   }
 }
 
-int& IntScalarField::getValue(int i, int j, int k) { return data_[index2array(i, j, k)]; }
-
 void IntScalarField::show(const std::string title) {
   std::cout << std::endl << "--- " << title << " ---" << std::endl;
   for (int k = 0; k < sizeZ_; k++) {
@@ -6,10 +6,33 @@
 /** Storage of a scalar field
  *
  * Parent of storage classes. Contains the data pointer and sizes in each
- * dimension.
+ * dimension. The data array starts on a cache line. With ENABLE_FIELD_PADDING,
+ * every row in x is padded to whole cache lines, so that the rows start on
+ * cache lines as well.
  */
 template <class DataType>
 class Field {
+private:
+  /** Number of positions from the start of one row to the next
+   *
+   * Padded rows take an odd number of cache lines, so that the rows around a
+   * cell do not map to the same cache sets, as rows of power-of-two sizes would.
+   */
+  static int computePitch(int Nx, [[maybe_unused]] int components) {
+#ifdef ENABLE_FIELD_PADDING
+    const int bytes = components * sizeof(DataType);
+    const int line  = CACHE_LINE_SIZE;
+    const int step  = line / std::gcd(line, bytes); // Positions of a whole number of cache lines
+    int       pitch = (Nx + step - 1) / step * step;
+    if ((pitch * bytes / line) % 2 == 0) {
+      pitch += step;
+    }
+    return pitch;
+#else
+    return Nx;
+#endif
+  }
+
 protected:
   //! Pointer to the data array
   DataType* data_;
@@ -18,7 +41,8 @@ protected:
   const int sizeY_;      //! Size of the field in y direction, including ghost layers
   const int sizeZ_;      //! Size of the field in z direction, including ghost layers
   const int components_; //! Number of components per position
-  const int size_;       //! Total size of the data array
+  const int pitchX_;     //! Positions from one row to the next, including the padding
+  const int size_;       //! Total size of the data array, including the padding
 
 public:
   /** Constructor for the field
@@ -35,19 +59,16 @@ public:
     sizeY_(Ny),
     sizeZ_(Nz),
     components_(components),
-    size_(components * Nx * Ny * Nz) {
-
-    data_ = new DataType[size_];
+    pitchX_(computePitch(Nx, components)),
+    size_(components * pitchX_ * Ny * Nz) {
 
-    // Check if the data was allocated successfully
-    if (data_ == 0) {
-      throw std::runtime_error("Unable to allocate memory");
-    }
+    // Throws std::bad_alloc if the memory cannot be allocated
+    data_ = static_cast<DataType*>(::operator new(size_ * sizeof(DataType), std::align_val_t(CACHE_LINE_SIZE)));
   }
 
   virtual ~Field() {
     if (data_ != NULL) {
-      delete[] data_;
+      ::operator delete(data_, std::align_val_t(CACHE_LINE_SIZE));
       data_ = NULL;
     }
   }
@@ -70,6 +91,28 @@ public:
    */
   int getNz() const { return sizeZ_; }
 
+  /** Returns the number of positions from the start of one row in x to the next
+   *
+   * Equals the size in the x direction unless the rows are padded. Neighbours in
+   * y are components * getPitch() values apart, neighbours in z
+   * components * getPitch() * getNy().
+   *
+   * @return The pitch of the rows
+   */
+  int getPitch() const { return pitchX_; }
+
+  /** Returns the number of values in the data array, including the padding
+   *
+   * @return The size of the data array
+   */
+  int getSize() const { return size_; }
+
+  /** Returns the data array, aligned to CACHE_LINE_SIZE bytes
+   *
+   * @return Pointer to the value of the position (0, 0, 0)
+   */
+  DataType* getData() { return data_; }
+
   /** Index to array position mapper
    *
    * Index mapper. Converts the given index to the corresponding position
@@ -84,7 +127,7 @@ public:
   int index2array(int i, int j, int k = 0) const {
     ASSERTION((i < sizeX_) && (j < sizeY_) && (k < sizeZ_));
     ASSERTION((i >= 0) && (j >= 0) && (k >= 0));
-    return components_ * (i + (j * sizeX_) + (k * sizeX_ * sizeY_));
+    return components_ * (i + (j * pitchX_) + (k * pitchX_ * sizeY_));
   }
 };
 
@@ -125,7 +168,7 @@ public:
    * @param j y index
    * @param k z index. Not required for arrays of dimension two.
    */
-  RealType& getScalar(int i, int j, int k = 0);
+  RealType& getScalar(int i, int j, int k = 0) { return data_[index2array(i, j, k)]; }
 
   /** Prints the contents of the field
    *
@@ -175,7 +218,7 @@ public:
    * @param j y index
    * @param k z index
    */
-  RealType* getVector(int i, int j, int k = 0);
+  RealType* getVector(int i, int j, int k = 0) { return &data_[index2array(i, j, k)]; }
 
   /** Prints the contents of the field
    *
@@ -220,7 +263,7 @@ public:
    * @param j Y index
    * @param k Z index
    */
-  int& getValue(int i, int j, int k = 0);
+  int& getValue(int i, int j, int k = 0) { return data_[index2array(i, j, k)]; }
 
   void show(const std::string title = "");
 };
@@ -16,6 +16,9 @@ using RealType = double;
 static constexpr RealType MY_FLOAT_MAX = std::numeric_limits<RealType>::max();
 static constexpr RealType MY_FLOAT_MIN = std::numeric_limits<RealType>::min();
 
+// Alignment used for arrays that are traversed in the hot loops
+static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
 #define LIKELY(x) __builtin_expect(bool(x), 1)
 #define UNLIKELY(x) __builtin_expect(bool(x), 0)
 #define NORETURN [[noreturn]]
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "FlowField.hpp"
+#include "GlobalBoundaryFactory.hpp"
+#include "Iterators.hpp"
+#include "Parameters.hpp"
+
+#include "Stencils/FGHStencil.hpp"
+#include "Stencils/FGHTurbStencil.hpp"
+#include "Stencils/RHSStencil.hpp"
+
+/** Computes F, G, H, their wall values and the right-hand side of the pressure equation in one sweep
+ *
+ * Replaces a sweep of the FGH stencil, the wall FGH iterator and a sweep of the RHS stencil. The sweep goes row by
+ * row: it computes FGH of a row, lets the walls set their values in the row and then computes the right-hand side of
+ * the row, while FGH of the row and of the row below are still in cache. The right-hand side of a cell only depends
+ * on FGH of the cell itself and of its left, bottom and front neighbours, which are final by then.
+ *
+ * Tiles are shared among the OpenMP threads as in StencilFieldIterator. The bottom neighbours of the first row of a
+ * tile, and the front neighbours of its first plane, belong to other tiles, so their right-hand side is computed in
+ * a second pass over these rows once all tiles are done. Unlike the wall FGH iterator, the walls are not applied to
+ * the ghost cells beyond the upper ends of the walls, which are never read.
+ */
+template <class FGHStencilType>
+class FGHRHSIterator: public Iterator<FlowField> {
+private:
+  static constexpr int TILE_SIZE = 16; //! Rows of a tile in y and z
+
+  FGHStencilType&                       fghStencil_;
+  Stencils::RHSStencil&                 rhsStencil_;
+  Stencils::BoundaryStencil<FlowField>* wallStencils_[6]; //! FGH stencils of the walls, as in GlobalBoundaryFactory
+
+  template <int Dim>
+  void applyWalls(int j, int k, int endX, int endY, int endZ);
+
+  template <int Dim>
+  void sweep();
+
+public:
+  FGHRHSIterator(
+    FlowField&             flowField,
+    const Parameters&      parameters,
+    FGHStencilType&        fghStencil,
+    Stencils::RHSStencil&  rhsStencil,
+    GlobalBoundaryFactory& globalBoundaryFactory
+  );
+
+  virtual ~FGHRHSIterator() override = default;
+
+  virtual void iterate() override;
+};
+
+#include "FGHRHSIterator.cpph"
+
+// Instantiated in FGHStencil.cpp and FGHTurbStencil.cpp
+extern template class FGHRHSIterator<Stencils::FGHStencil>;
+extern template class FGHRHSIterator<Stencils::FGHTurbStencil>;
@@ -19,7 +19,8 @@ FlowField::FlowField(int Nx, int Ny):
   RHS_(ScalarField(Nx + 3, Ny + 3)),
   h_(ScalarField(Nx + 3, Ny + 3)),
   lm_(ScalarField(Nx + 3, Ny + 3)),
-  vt_(ScalarField(Nx + 3, Ny + 3)) {
+  vt_(ScalarField(Nx + 3, Ny + 3)),
+  concentration_(ScalarField(Nx + 3, Ny + 3)) {
 
   ASSERTION(Nx > 0);
   ASSERTION(Ny > 0);
@@ -39,7 +40,8 @@ FlowField::FlowField(int Nx, int Ny, int Nz):
   RHS_(ScalarField(Nx + 3, Ny + 3, Nz + 3)),
   h_(ScalarField(Nx + 3, Ny + 3, Nz + 3)),
   lm_(ScalarField(Nx + 3, Ny + 3, Nz + 3)),
-  vt_(ScalarField(Nx + 3, Ny + 3, Nz + 3)) {
+  vt_(ScalarField(Nx + 3, Ny + 3, Nz + 3)),
+  concentration_(ScalarField(Nx + 3, Ny + 3, Nz + 3)) {
 
   ASSERTION(Nx > 0);
   ASSERTION(Ny > 0);
@@ -78,36 +80,11 @@ FlowField::FlowField(const Parameters& parameters):
   ),
   vt_(
     parameters.geometry.dim == 2 ? ScalarField(sizeX_ + 3, sizeY_ + 3) : ScalarField(sizeX_ + 3, sizeY_ + 3, sizeZ_ + 3)
+  ),
+  concentration_(
+    parameters.geometry.dim == 2 ? ScalarField(sizeX_ + 3, sizeY_ + 3) : ScalarField(sizeX_ + 3, sizeY_ + 3, sizeZ_ + 3)
   ) {}
 
-int FlowField::getNx() const { return sizeX_; }
-
-int FlowField::getNy() const { return sizeY_; }
-
-int FlowField::getNz() const { return sizeZ_; }
-
-int FlowField::getCellsX() const { return cellsX_; }
-
-int FlowField::getCellsY() const { return cellsY_; }
-
-int FlowField::getCellsZ() const { return cellsZ_; }
-
-ScalarField& FlowField::getPressure() { return pressure_; }
-
-VectorField& FlowField::getVelocity() { return velocity_; }
-
-IntScalarField& FlowField::getFlags() { return flags_; }
-
-VectorField& FlowField::getFGH() { return FGH_; }
-
-ScalarField& FlowField::getRHS() { return RHS_; }
-
-ScalarField& FlowField::getH() { return h_; }
-
-ScalarField& FlowField::getVt() { return vt_; }
-
-ScalarField& FlowField::getLm() { return lm_; }
-
 void FlowField::getPressureAndVelocity(RealType& pressure, RealType* const velocity, int i, int j) {
   RealType* vHere = getVelocity().getVector(i, j);
   RealType* vLeft = getVelocity().getVector(i - 1, j);
@@ -29,6 +29,8 @@ private:
   ScalarField vt_; //! Turbulent Viscosity
   ScalarField lm_; //! Mixing Length
 
+  ScalarField concentration_; //! Number of tracer particles per volume, deposited by the particle simulation
+
 public:
   /** Constructor for the 2D flow field
    *
@@ -66,36 +68,38 @@ public:
    *
    * @return Number of cells in the X direction
    */
-  int getNx() const;
+  int getNx() const { return sizeX_; }
 
   /** Obtain size in the Y direction
    *
    * @return Number of cells in the Y direction
    */
-  int getNy() const;
+  int getNy() const { return sizeY_; }
 
   /** Obtain size in the Z direction
    *
    * @return Number of cells in the Z direction
    */
-  int getNz() const;
+  int getNz() const { return sizeZ_; }
+
+  int getCellsX() const { return cellsX_; }
+  int getCellsY() const { return cellsY_; }
+  int getCellsZ() const { return cellsZ_; }
 
-  int getCellsX() const;
-  int getCellsY() const;
-  int getCellsZ() const;
+  ScalarField& getPressure() { return pressure_; }
+  VectorField& getVelocity() { return velocity_; }
 
-  ScalarField& getPressure();
-  VectorField& getVelocity();
+  IntScalarField& getFlags() { return flags_; }
 
-  IntScalarField& getFlags();
+  VectorField& getFGH() { return FGH_; }
 
-  VectorField& getFGH();
+  ScalarField& getRHS() { return RHS_; }
 
-  ScalarField& getRHS();
+  ScalarField& getH() { return h_; }
+  ScalarField& getVt() { return vt_; }
+  ScalarField& getLm() { return lm_; }
 
-  ScalarField& getH();
-  ScalarField& getVt();
-  ScalarField& getLm();
+  ScalarField& getConcentration() { return concentration_; }
 
   void getPressureAndVelocity(RealType& pressure, RealType* const velocity, int i, int j);
   void getPressureAndVelocity(RealType& pressure, RealType* const velocity, int i, int j, int k);
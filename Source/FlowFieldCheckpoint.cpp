@@ -0,0 +1,127 @@
+#include "StdAfx.hpp"
+
+#include "FlowFieldCheckpoint.hpp"
+
+using Bounds = std::array<std::array<int, 2>, 3>;
+
+// Global cells of the subdomain of the rank, as lower and upper bounds along each axis
+static Bounds getBounds(const Parameters& parameters) {
+  Bounds bounds;
+  for (int d = 0; d < 3; d++) {
+    const bool inDomain = d < parameters.geometry.dim;
+    bounds[d][0]        = inDomain ? parameters.parallel.firstCorner[d] : 0;
+    bounds[d][1]        = inDomain ? bounds[d][0] + parameters.parallel.localSize[d] : 1;
+  }
+  return bounds;
+}
+
+// Visits the global cells within the bounds, with i running fastest
+template <class Visit>
+static void traverse(const Bounds& bounds, Visit visit) {
+  for (int k = bounds[2][0]; k < bounds[2][1]; k++) {
+    for (int j = bounds[1][0]; j < bounds[1][1]; j++) {
+      for (int i = bounds[0][0]; i < bounds[0][1]; i++) {
+        visit(i, j, k);
+      }
+    }
+  }
+}
+
+std::string FlowFieldCheckpoint::getFileName(const std::string& prefix, int rank, std::int64_t timeSteps) {
+  return "Output/" + prefix + "/" + prefix + "flow." + std::to_string(rank) + "." + std::to_string(timeSteps) + ".bin";
+}
+
+void FlowFieldCheckpoint::write(const std::string& fileName, FlowField& flowField, const Parameters& parameters) {
+  const int    dim    = parameters.geometry.dim;
+  const Bounds bounds = getBounds(parameters);
+
+  Header header;
+  std::copy(std::begin(MAGIC), std::end(MAGIC), header.magic);
+  header.version = VERSION;
+  header.dim     = dim;
+  for (int d = 0; d < 3; d++) {
+    header.bounds[d][0] = bounds[d][0];
+    header.bounds[d][1] = bounds[d][1];
+  }
+
+  // Pressure and velocity of every cell, local cells start after the two ghost layers
+  std::vector<double> values;
+  traverse(bounds, [&](int i, int j, int k) {
+    const int li = i - bounds[0][0] + 2;
+    const int lj = j - bounds[1][0] + 2;
+    const int lk = (dim == 3) ? k - bounds[2][0] + 2 : 0;
+    values.push_back(flowField.getPressure().getScalar(li, lj, lk));
+    const RealType* velocity = flowField.getVelocity().getVector(li, lj, lk);
+    values.insert(values.end(), velocity, velocity + dim);
+  });
+
+  const std::string temporaryName = fileName + ".tmp";
+  {
+    std::ofstream file(temporaryName, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+    file.close();
+    if (!file) {
+      spdlog::error("Cannot write the flow field checkpoint {}", temporaryName);
+      throw std::runtime_error("Error while writing the flow field checkpoint");
+    }
+  }
+  std::filesystem::rename(temporaryName, fileName);
+}
+
+void FlowFieldCheckpoint::read(
+  const std::string& prefix, int ranks, std::int64_t timeSteps, FlowField& flowField, const Parameters& parameters
+) {
+  const int    dim    = parameters.geometry.dim;
+  const Bounds bounds = getBounds(parameters);
+
+  int restored = 0;
+  for (int rank = 0; rank < ranks; rank++) {
+    const std::string fileName = getFileName(prefix, rank, timeSteps);
+    std::ifstream     file(fileName, std::ios::binary);
+    if (!file) {
+      throw std::runtime_error("Cannot open the flow field checkpoint " + fileName);
+    }
+
+    Header header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(Header))
+        || !std::equal(std::begin(MAGIC), std::end(MAGIC), header.magic) || header.version != VERSION) {
+      throw std::runtime_error(fileName + " is not a flow field checkpoint");
+    }
+    if (header.dim != dim) {
+      throw std::runtime_error("The flow field checkpoint was written by a simulation of another dimension");
+    }
+
+    // Only the checkpoints of subdomains which overlap the one of this rank are read in full
+    Bounds stored, shared;
+    int    sizes[3];
+    for (int d = 0; d < 3; d++) {
+      stored[d] = {header.bounds[d][0], header.bounds[d][1]};
+      shared[d] = {std::max(stored[d][0], bounds[d][0]), std::min(stored[d][1], bounds[d][1])};
+      sizes[d]  = std::max(0, stored[d][1] - stored[d][0]);
+    }
+    if (shared[0][0] >= shared[0][1] || shared[1][0] >= shared[1][1] || shared[2][0] >= shared[2][1]) {
+      continue;
+    }
+
+    std::vector<double> values((1 + dim) * sizes[0] * sizes[1] * sizes[2]);
+    if (!file.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(double))) {
+      throw std::runtime_error("The flow field checkpoint " + fileName + " is truncated");
+    }
+    traverse(shared, [&](int i, int j, int k) {
+      const int     cell  = (i - stored[0][0]) + sizes[0] * ((j - stored[1][0]) + sizes[1] * (k - stored[2][0]));
+      const double* value = values.data() + (1 + dim) * cell;
+      const int     li    = i - bounds[0][0] + 2;
+      const int     lj    = j - bounds[1][0] + 2;
+      const int     lk    = (dim == 3) ? k - bounds[2][0] + 2 : 0;
+      flowField.getPressure().getScalar(li, lj, lk) = value[0];
+      std::copy(value + 1, value + 1 + dim, flowField.getVelocity().getVector(li, lj, lk));
+      restored++;
+    });
+  }
+
+  const int cells = (bounds[0][1] - bounds[0][0]) * (bounds[1][1] - bounds[1][0]) * (bounds[2][1] - bounds[2][0]);
+  if (restored != cells) {
+    throw std::runtime_error("The flow field checkpoints do not cover the subdomain");
+  }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "StdAfx.hpp"
+
+#include "FlowField.hpp"
+#include "Parameters.hpp"
+
+/** Binary checkpoints of the flow field, written along with the particle checkpoints
+ *
+ * Every rank writes the pressure and the velocity of the cells it owns, without the ghost layers, together with the
+ * global cells of its subdomain. A run with other subdomains restores its cells from the checkpoints of all ranks
+ * whose subdomains overlap its own, as LoadBalancer::redistribute() does after a rebalance. Checkpoints are written in
+ * the byte order of the machine.
+ */
+namespace FlowFieldCheckpoint {
+
+  constexpr char         MAGIC[8] = {'N', 'S', 'E', 'O', 'F', 'F', 'L', 'W'};
+  constexpr std::int32_t VERSION  = 1;
+
+  struct Header {
+    char         magic[8];
+    std::int32_t version;
+    std::int32_t dim;          //! Dimension of the simulation which wrote the checkpoint
+    std::int32_t bounds[3][2]; //! Global cells of the subdomain along each axis, as lower and upper bounds
+  };
+
+  /** Name of the checkpoint of a rank at a time step, in the output folder of the given VTK prefix */
+  std::string getFileName(const std::string& prefix, int rank, std::int64_t timeSteps);
+
+  /** Writes the pressure and the velocity of the cells of the subdomain atomically, like ParticleCheckpoint::write() */
+  void write(const std::string& fileName, FlowField& flowField, const Parameters& parameters);
+
+  /** Restores the pressure and the velocity of the cells of the subdomain from the checkpoints of a previous run
+   *
+   * The ghost layers are left to the parallel manager and the boundary iterators.
+   *
+   * @param prefix VTK prefix of the previous run
+   * @param ranks Number of ranks of the previous run
+   * @param timeSteps Time step of the checkpoints
+   */
+  void read(
+    const std::string& prefix, int ranks, std::int64_t timeSteps, FlowField& flowField, const Parameters& parameters
+  );
+
+} // namespace FlowFieldCheckpoint
@@ -153,3 +153,5 @@ GlobalBoundaryIterator<FlowField> GlobalBoundaryFactory::getGlobalBoundaryVeloci
     0
   );
 }
+
+Stencils::BoundaryStencil<FlowField>& GlobalBoundaryFactory::getFGHStencil(int wall) { return *(FGHStencils_[wall]); }
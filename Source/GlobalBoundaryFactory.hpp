@@ -29,4 +29,7 @@ public:
 
   GlobalBoundaryIterator<FlowField> getGlobalBoundaryFGHIterator(FlowField& flowField);
   GlobalBoundaryIterator<FlowField> getGlobalBoundaryVelocityIterator(FlowField& flowField);
+
+  /** Returns the FGH stencil of a wall: 0 left, 1 right, 2 bottom, 3 top, 4 front, 5 back */
+  Stencils::BoundaryStencil<FlowField>& getFGHStencil(int wall);
 };
@@ -58,6 +58,46 @@ public:
   virtual void iterate() override;
 };
 
+/** Field iterator bound to the type of its stencil
+ *
+ * Iterates over the same cells as FieldIterator, but calls the apply() of StencilType directly instead of through
+ * the virtual FieldStencil interface, and checks the dimension once per sweep instead of around the loop nests.
+ * Instantiated in the translation unit of the stencil, the stencil can be inlined into the loop nest. The hot
+ * stencils do so explicitly; FieldIterator remains for all others.
+ *
+ * The cells are split into tiles of TILE_SIZE rows in y and z, which the OpenMP threads share. Every thread applies
+ * its own copy of the stencil, so that scratch members of the stencil are not shared. Stencils which accumulate a
+ * result provide reduce(const StencilType&), which merges the copy of a thread into the stencil after the sweep; it
+ * has to be independent of the order of the threads.
+ */
+template <class FlowFieldType, class StencilType>
+class StencilFieldIterator: public Iterator<FlowFieldType> {
+private:
+  static constexpr int TILE_SIZE = 16; //! Rows of a tile in y and z. Rows are not split along x.
+
+  StencilType& stencil_;
+
+  const int lowOffset_;
+  const int highOffset_;
+
+  template <int Dim>
+  void sweep();
+
+public:
+  StencilFieldIterator(
+    FlowFieldType&    flowField,
+    const Parameters& parameters,
+    StencilType&      stencil,
+    int               lowOffset  = 0,
+    int               highOffset = 0
+  );
+
+  virtual ~StencilFieldIterator() override = default;
+
+  /** Volume iteration over the field, as in FieldIterator::iterate() */
+  virtual void iterate() override;
+};
+
 template <class FlowFieldType>
 class GlobalBoundaryIterator: public Iterator<FlowFieldType> {
 private:
@@ -7,12 +7,61 @@
 #include "Simulation.hpp"
 #include "TurbulentSimulation.hpp"
 
+#include "ParallelManagers/LoadBalancer.hpp"
 #include "ParallelManagers/PetscParallelConfiguration.hpp"
 
 #ifndef NDEBUG
 #include <cfenv>
 #pragma STDC FENV_ACCESS ON
 #endif
+
+// Moves the boundaries of the subdomains if the work of the ranks is out of balance, and rebuilds the flow field and
+// the simulations for the new subdomains. The turbulence and FGH fields are recomputed by the next time step.
+static void rebalance(
+  Parameters&                     parameters,
+  ParallelManagers::LoadBalancer& loadBalancer,
+  FlowField*&                     flowField,
+  Simulation*&                    simulation,
+  ParticleSimulationBase*&        particleSimulation
+) {
+  std::array<std::vector<int>, 3> layerCounts;
+  particleSimulation->endCommunicateParticles();
+  particleSimulation->countParticles(layerCounts);
+  if (!loadBalancer.balance(layerCounts, particleSimulation->getNumberOfParticles())) {
+    return;
+  }
+
+  particleSimulation->suspendParticles();
+  loadBalancer.apply();
+  delete parameters.meshsize;
+  MeshsizeFactory::getInstance().initMeshsize(parameters);
+
+  FlowField*  balancedFlowField  = new FlowField(parameters);
+  Simulation* balancedSimulation = NULL;
+  if (parameters.simulation.type == "turbulence") {
+    balancedSimulation = new TurbulentSimulation(parameters, *balancedFlowField);
+  } else {
+    balancedSimulation = new Simulation(parameters, *balancedFlowField);
+  }
+  balancedSimulation->initializeFlowField();
+  loadBalancer.redistribute(*flowField, *balancedFlowField);
+  balancedSimulation->communicateFlowField();
+
+  ParticleSimulationBase* balancedParticleSimulation = NULL;
+  if (parameters.geometry.dim == 2) {
+    balancedParticleSimulation = new ParticleSimulation<2>(parameters, *balancedFlowField);
+  } else {
+    balancedParticleSimulation = new ParticleSimulation<3>(parameters, *balancedFlowField);
+  }
+  balancedParticleSimulation->adoptParticles(*particleSimulation);
+
+  delete particleSimulation;
+  delete simulation;
+  delete flowField;
+  particleSimulation = balancedParticleSimulation;
+  simulation         = balancedSimulation;
+  flowField          = balancedFlowField;
+}
 int main(int argc, char* argv[]) {
   spdlog::set_level(spdlog::level::info);
 
@@ -23,7 +72,12 @@ int main(int argc, char* argv[]) {
 #ifdef ENABLE_PETSC
   PetscInitialize(&argc, &argv, "petsc_commandline_arg", PETSC_NULL);
 #else
-  MPI_Init(&argc, &argv);
+  // Only the main thread communicates, OpenMP threads are used for computations in between
+  int provided = MPI_THREAD_SINGLE;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+  if (provided < MPI_THREAD_FUNNELED) {
+    spdlog::warn("The MPI library does not support calls from the main thread of a multithreaded process.");
+  }
 #endif
 
   MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
@@ -57,10 +111,11 @@ int main(int argc, char* argv[]) {
   Parameters    parameters;
   configuration.loadParameters(parameters);
   ParallelManagers::PetscParallelConfiguration parallelConfiguration(parameters);
+  ParallelManagers::LoadBalancer               loadBalancer(parameters, parallelConfiguration);
   MeshsizeFactory::getInstance().initMeshsize(parameters);
-  FlowField*          flowField          = NULL;
-  Simulation*         simulation         = NULL;
-  ParticleSimulation* particleSimulation = NULL;
+  FlowField*              flowField          = NULL;
+  Simulation*             simulation         = NULL;
+  ParticleSimulationBase* particleSimulation = NULL;
 
   spdlog::debug(
     "Processor {} with index {}, {}, {} is computing the size of its subdomain and obtains {}, {} and {}.",
@@ -114,8 +169,15 @@ int main(int argc, char* argv[]) {
   simulation->initializeFlowField();
 
   if (parameters.particles.enable == true) {
-    particleSimulation = new ParticleSimulation(parameters, *flowField);
-    particleSimulation->initializeParticles();
+    // The particle kernels are compiled for the dimension of the geometry
+    if (parameters.geometry.dim == 2) {
+      particleSimulation = new ParticleSimulation<2>(parameters, *flowField);
+    } else {
+      particleSimulation = new ParticleSimulation<3>(parameters, *flowField);
+    }
+    if (parameters.particles.restart.empty()) {
+      particleSimulation->initializeParticles();
+    }
   }
 
   // flowField->getFlags().show();
@@ -126,11 +188,33 @@ int main(int argc, char* argv[]) {
   RealType timeInject = parameters.particles.injectInterval;
   int      timeSteps  = 0;
 
+  // The time loop continues from the checkpoints of the particles and the flow field
+  if (particleSimulation && !parameters.particles.restart.empty()) {
+    const ParticleCheckpoint::State state = particleSimulation->readCheckpoint(parameters.particles.restart);
+    timeSteps                             = state.timeSteps;
+    time                                  = state.time;
+    timeInject                            = state.timeInject;
+
+    // Only the inner cells are restored, the ghost layers are filled by the neighbours and the walls
+    simulation->communicateFlowField();
+    while (timeVtk <= time) {
+      timeVtk += parameters.vtk.interval;
+    }
+    while (timeStdOut <= time) {
+      timeStdOut += parameters.stdOut.interval;
+    }
+  }
+
   // Plot initial state
 #ifndef DISABLE_OUTPUT
+  if (particleSimulation) {
+    particleSimulation->depositParticles();
+  }
   simulation->plotVTK(timeSteps, time);
-  if (particleSimulation)
+  if (particleSimulation) {
     particleSimulation->plot(timeSteps, time);
+    particleSimulation->recordTrajectories(timeSteps, time);
+  }
 #endif
 
   Clock clock;
@@ -138,7 +222,14 @@ int main(int argc, char* argv[]) {
   while (time < parameters.simulation.finalTime) {
     simulation->solveTimestep();
     if (particleSimulation) {
-      particleSimulation->solveTimestep();
+      // The particle migration of the previous time step overlaps with the flow solve of this one
+      particleSimulation->endCommunicateParticles();
+      particleSimulation->advectParticles(parameters.timestep.dt);
+#ifndef DISABLE_OUTPUT
+      // The particles which left the subdomain are recorded before they are sent to their new owners
+      particleSimulation->recordTrajectories(timeSteps + 1, time + parameters.timestep.dt);
+#endif
+      particleSimulation->beginCommunicateParticles();
       if (timeInject <= time) {
         particleSimulation->initializeParticles();
         timeInject += parameters.particles.injectInterval;
@@ -147,6 +238,16 @@ int main(int argc, char* argv[]) {
     timeSteps++;
     time += parameters.timestep.dt;
 
+    if (particleSimulation && parameters.parallel.rebalanceInterval > 0
+        && timeSteps % parameters.parallel.rebalanceInterval == 0) {
+      rebalance(parameters, loadBalancer, flowField, simulation, particleSimulation);
+    }
+
+    if (particleSimulation && parameters.particles.checkpointInterval > 0
+        && timeSteps % parameters.particles.checkpointInterval == 0) {
+      particleSimulation->writeCheckpoint(timeSteps, timeInject);
+    }
+
     if ((rank == 0) && (timeStdOut <= time)) {
       spdlog::info("Current time: {}\tTimestep: {}", time, parameters.timestep.dt);
       timeStdOut += parameters.stdOut.interval;
@@ -154,9 +255,14 @@ int main(int argc, char* argv[]) {
 
     if (timeVtk <= time) {
 #ifndef DISABLE_OUTPUT
+      if (particleSimulation) {
+        particleSimulation->endCommunicateParticles();
+        particleSimulation->depositParticles();
+      }
       simulation->plotVTK(timeSteps, time);
       if (particleSimulation) {
         particleSimulation->plot(timeSteps, time);
+        particleSimulation->writeStatistics(timeSteps, time);
       }
 #endif
       timeVtk += parameters.vtk.interval;
@@ -166,9 +272,20 @@ int main(int argc, char* argv[]) {
   if (parameters.parallel.rank == 0)
     spdlog::info("Finished simulation with a duration of {}ns", clock.getTime());
 
+  // The last exchange is completed by all ranks together, the particle simulation does not communicate when deleted
+  if (particleSimulation) {
+    particleSimulation->endCommunicateParticles();
+  }
+
     // Plot final solution
 #ifndef DISABLE_OUTPUT
+  if (particleSimulation) {
+    particleSimulation->depositParticles();
+  }
   simulation->plotVTK(timeSteps, time);
+  if (particleSimulation) {
+    particleSimulation->writeStatistics(timeSteps, time);
+  }
 #endif
 
   delete simulation;
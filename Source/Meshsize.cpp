@@ -58,4 +58,60 @@ TanhMeshStretching::TanhMeshStretching(const Parameters& parameters, bool stretc
     stretchZ
       ? 0.5 * parameters.geometry.lengthZ * (1.0 + tanh(deltaS_ * (2.0 / sizeZ_ - 1.0)) / tanhDeltaS_)
       : uniformMeshsize_.getDz(0, 0, 0)
-  ) {}
+  ) {
+
+  const bool     stretch[3] = {stretchX_, stretchY_, stretchZ_};
+  const int      sizes[3]   = {sizeX_, sizeY_, sizeZ_};
+  const RealType lengths[3] = {lengthX_, lengthY_, lengthZ_};
+  const RealType minima[3]  = {dxMin_, dyMin_, dzMin_};
+
+  for (int d = 0; d < parameters.geometry.dim; d++) {
+    if (stretch[d]) {
+      vertices_[d].resize(sizes[d] + 1);
+      for (int index = 0; index <= sizes[d]; index++) {
+        // Global index, i.e. local index with the first corner at the origin
+        vertices_[d][index] = computeCoordinate(index + 2, 0, sizes[d], lengths[d], minima[d]);
+      }
+    }
+  }
+}
+
+int UniformMeshsize::locateCell(int d, RealType coordinate) const {
+  const RealType meshsize    = (d == 0) ? dx_ : (d == 1) ? dy_ : dz_;
+  const int      firstCorner = (d == 0) ? firstCornerX_ : (d == 1) ? firstCornerY_ : firstCornerZ_;
+
+  int index = static_cast<int>(std::floor(coordinate / meshsize)) + 2 - firstCorner;
+  if (meshsize * (firstCorner - 2 + index) > coordinate) {
+    index--;
+  } else if (meshsize * (firstCorner - 1 + index) <= coordinate) {
+    index++;
+  }
+  return index;
+}
+
+int TanhMeshStretching::locateCell(int d, RealType coordinate) const {
+  const std::vector<RealType>& vertices = vertices_[d];
+  if (vertices.empty()) {
+    return uniformMeshsize_.locateCell(d, coordinate);
+  }
+
+  const int      size        = static_cast<int>(vertices.size()) - 1;
+  const int      firstCorner = (d == 0) ? firstCornerX_ : (d == 1) ? firstCornerY_ : firstCornerZ_;
+  const RealType length      = (d == 0) ? lengthX_ : (d == 1) ? lengthY_ : lengthZ_;
+  const RealType meshsize    = (d == 0) ? dxMin_ : (d == 1) ? dyMin_ : dzMin_;
+
+  int index;
+  if (vertices.front() <= coordinate && coordinate < vertices.back()) {
+    index = static_cast<int>(std::upper_bound(vertices.begin(), vertices.end(), coordinate) - vertices.begin()) - 1;
+  } else {
+    // Outside of the domain, the mesh continues equidistantly with the smallest meshsize
+    index = (coordinate < vertices.front()) ? static_cast<int>(std::floor(coordinate / meshsize))
+                                            : size + static_cast<int>(std::floor((coordinate - length) / meshsize));
+    if (computeCoordinate(index + 2, 0, size, length, meshsize) > coordinate) {
+      index--;
+    } else if (computeCoordinate(index + 3, 0, size, length, meshsize) <= coordinate) {
+      index++;
+    }
+  }
+  return index + 2 - firstCorner;
+}
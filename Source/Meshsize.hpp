@@ -29,6 +29,11 @@ public:
   virtual RealType getPosX(int i, int j) const = 0;
   virtual RealType getPosY(int i, int j) const = 0;
 
+  // Returns the local index of the cell along direction d (0: x, 1: y, 2: z) which contains the given coordinate,
+  // i.e. the index i with getPosX(i, 0, 0) <= coordinate < getPosX(i + 1, 0, 0) for d = 0. Coordinates outside of
+  // this process yield indices of ghost cells or beyond.
+  virtual int locateCell(int d, RealType coordinate) const = 0;
+
   // Returns the min. meshsize used in this simulation
   // -> required for adaptive time stepping.
   virtual RealType getDxMin() const = 0;
@@ -79,6 +84,9 @@ public:
   inline virtual RealType getPosX(int i, int j) const override { return getPosX(i, j, 0); }
   inline virtual RealType getPosY(int i, int j) const override { return getPosY(i, j, 0); }
 
+  // Closed form, corrected by one cell where rounding disagrees with getPosX/Y/Z
+  virtual int locateCell(int d, RealType coordinate) const override;
+
   inline virtual RealType getDxMin() const override { return dx_; }
   inline virtual RealType getDyMin() const override { return dy_; }
   inline virtual RealType getDzMin() const override { return dz_; }
@@ -112,6 +120,9 @@ private:
   const RealType        dyMin_;
   const RealType        dzMin_;
 
+  //! Coordinates of the vertices 0 to size of the global stretched mesh along each direction, empty if not stretched
+  std::array<std::vector<RealType>, 3> vertices_;
+
   // Computes the coordinate of the lower/left/front corner of the 1D-cell at index i w.r.t. having "size" cells along
   // an interval of length "length". We refer to local indexing, so "firstCorner" denotes the first non-ghost cell index
   // of this process. We use a stretched mesh for all nodes inside the comput. bounding box, and a regular mesh outside
@@ -208,6 +219,9 @@ public:
   inline virtual RealType getPosX(int i, int j) const override { return getPosX(i, j, 0); }
   inline virtual RealType getPosY(int i, int j) const override { return getPosY(i, j, 0); }
 
+  // Binary search over the vertices of stretched directions, closed form outside of the domain
+  virtual int locateCell(int d, RealType coordinate) const override;
+
   inline virtual RealType getDxMin() const override { return dxMin_; }
   inline virtual RealType getDyMin() const override { return dyMin_; }
   inline virtual RealType getDzMin() const override { return dzMin_; }
@@ -0,0 +1,215 @@
+#include "StdAfx.hpp"
+
+#include "LoadBalancer.hpp"
+
+// Subdomains are kept at least this thick, so that the stencils of a subdomain only reach its direct neighbours
+static constexpr int MIN_SUBDOMAIN_CELLS = 2;
+
+ParallelManagers::LoadBalancer::LoadBalancer(Parameters& parameters, PetscParallelConfiguration& configuration):
+  parameters_(parameters),
+  configuration_(configuration) {
+
+  if (parameters.parallel.rebalanceAxes < 1 || parameters.parallel.rebalanceAxes > parameters.geometry.dim) {
+    throw std::runtime_error("The number of rebalanced axes has to lie between 1 and the dimension of the geometry");
+  }
+}
+
+bool ParallelManagers::LoadBalancer::balance(const std::array<std::vector<int>, 3>& layerCounts, int particles) {
+  const int      dim  = parameters_.geometry.dim;
+  const RealType cost = parameters_.parallel.particleCost;
+
+  // Imbalance as the ratio of the largest to the mean work of a process
+  int nproc;
+  MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+  RealType localWork = cost * particles;
+  RealType cells     = 1.0;
+  for (int d = 0; d < dim; d++) {
+    cells *= parameters_.parallel.localSize[d];
+  }
+  localWork += cells;
+  RealType maxWork = 0.0, totalWork = 0.0;
+  MPI_Allreduce(&localWork, &maxWork, 1, MY_MPI_FLOAT, MPI_MAX, PETSC_COMM_WORLD);
+  MPI_Allreduce(&localWork, &totalWork, 1, MY_MPI_FLOAT, MPI_SUM, PETSC_COMM_WORLD);
+  if (maxWork * nproc <= parameters_.parallel.imbalanceThreshold * totalWork) {
+    return false;
+  }
+
+  const int geometrySizes[3] = {parameters_.geometry.sizeX, parameters_.geometry.sizeY, parameters_.geometry.sizeZ};
+  balancedCells_             = configuration_.getCells();
+  for (int d = 0; d < parameters_.parallel.rebalanceAxes; d++) {
+    std::vector<int> counts(geometrySizes[d]);
+    MPI_Allreduce(layerCounts[d].data(), counts.data(), geometrySizes[d], MPI_INT, MPI_SUM, PETSC_COMM_WORLD);
+
+    // Every layer holds the cells spanned by the other axes
+    RealType layerCells = 1.0;
+    for (int e = 0; e < dim; e++) {
+      if (e != d) {
+        layerCells *= geometrySizes[e];
+      }
+    }
+
+    std::vector<RealType> work(geometrySizes[d]);
+    for (int c = 0; c < geometrySizes[d]; c++) {
+      work[c] = layerCells + cost * counts[c];
+    }
+
+    const int parts   = parameters_.parallel.numProcessors[d];
+    balancedCells_[d] = partition(work, parts, std::min(MIN_SUBDOMAIN_CELLS, geometrySizes[d] / parts));
+  }
+
+  return balancedCells_ != configuration_.getCells();
+}
+
+void ParallelManagers::LoadBalancer::apply() {
+  previousCells_ = configuration_.getCells();
+  configuration_.setSizes(balancedCells_);
+}
+
+void ParallelManagers::LoadBalancer::redistribute(FlowField& from, FlowField& to) const {
+  const int dim    = parameters_.geometry.dim;
+  const int values = 1 + dim; // Pressure and velocity components of a cell
+
+  int nproc;
+  MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+
+  // First global cell of every processor along each axis, followed by the size of the geometry
+  const auto startsOf = [dim](const std::array<std::vector<int>, 3>& cells) {
+    std::array<std::vector<int>, 3> starts;
+    for (int d = 0; d < 3; d++) {
+      starts[d].assign(1, 0);
+      if (d < dim) {
+        for (const int size : cells[d]) {
+          starts[d].push_back(starts[d].back() + size);
+        }
+      } else {
+        starts[d].push_back(1);
+      }
+    }
+    return starts;
+  };
+  const std::array<std::vector<int>, 3> previousStarts = startsOf(previousCells_);
+  const std::array<std::vector<int>, 3> currentStarts  = startsOf(configuration_.getCells());
+
+  // Global cells of the subdomain of a rank, as lower and upper bounds along each axis
+  const int* numProcessors = parameters_.parallel.numProcessors;
+  const auto box           = [&](const std::array<std::vector<int>, 3>& starts, int rank) {
+    const int indices[3] = {
+      rank % numProcessors[0],
+      (rank / numProcessors[0]) % numProcessors[1],
+      (dim == 3) ? rank / (numProcessors[0] * numProcessors[1]) : 0};
+    std::array<std::array<int, 2>, 3> bounds;
+    for (int d = 0; d < 3; d++) {
+      bounds[d] = {starts[d][indices[d]], starts[d][indices[d] + 1]};
+    }
+    return bounds;
+  };
+  const auto intersect = [](const std::array<std::array<int, 2>, 3>& a, const std::array<std::array<int, 2>, 3>& b) {
+    std::array<std::array<int, 2>, 3> bounds;
+    for (int d = 0; d < 3; d++) {
+      bounds[d] = {std::max(a[d][0], b[d][0]), std::min(a[d][1], b[d][1])};
+    }
+    return bounds;
+  };
+  const auto volume = [](const std::array<std::array<int, 2>, 3>& bounds) {
+    int cells = 1;
+    for (int d = 0; d < 3; d++) {
+      cells *= std::max(0, bounds[d][1] - bounds[d][0]);
+    }
+    return cells;
+  };
+
+  const int                               rank        = parameters_.parallel.rank;
+  const std::array<std::array<int, 2>, 3> previousBox = box(previousStarts, rank);
+  const std::array<std::array<int, 2>, 3> currentBox  = box(currentStarts, rank);
+  std::vector<int>                        sendCounts(nproc), recvCounts(nproc), sendDispls(nproc), recvDispls(nproc);
+  std::vector<RealType>                   sendBuffer, recvBuffer;
+
+  // Both sides traverse a shared block of cells in the same order, so the values need no cell indices
+  const auto traverse = [](const std::array<std::array<int, 2>, 3>& bounds, auto visit) {
+    for (int k = bounds[2][0]; k < bounds[2][1]; k++) {
+      for (int j = bounds[1][0]; j < bounds[1][1]; j++) {
+        for (int i = bounds[0][0]; i < bounds[0][1]; i++) {
+          visit(i, j, k);
+        }
+      }
+    }
+  };
+
+  for (int r = 0; r < nproc; r++) {
+    const std::array<std::array<int, 2>, 3> shared = intersect(previousBox, box(currentStarts, r));
+    sendDispls[r]                                  = sendBuffer.size();
+    sendCounts[r]                                  = values * volume(shared);
+    if (sendCounts[r] > 0) {
+      traverse(shared, [&](int i, int j, int k) {
+        // Local cells of the subdomain start after the two ghost layers
+        const int li = i - previousBox[0][0] + 2;
+        const int lj = j - previousBox[1][0] + 2;
+        const int lk = (dim == 3) ? k - previousBox[2][0] + 2 : 0;
+        sendBuffer.push_back(from.getPressure().getScalar(li, lj, lk));
+        const RealType* velocity = from.getVelocity().getVector(li, lj, lk);
+        sendBuffer.insert(sendBuffer.end(), velocity, velocity + dim);
+      });
+    }
+
+    recvDispls[r] = (r == 0) ? 0 : recvDispls[r - 1] + recvCounts[r - 1];
+    recvCounts[r] = values * volume(intersect(box(previousStarts, r), currentBox));
+  }
+  recvBuffer.resize(recvDispls[nproc - 1] + recvCounts[nproc - 1]);
+
+  MPI_Alltoallv(
+    sendBuffer.data(),
+    sendCounts.data(),
+    sendDispls.data(),
+    MY_MPI_FLOAT,
+    recvBuffer.data(),
+    recvCounts.data(),
+    recvDispls.data(),
+    MY_MPI_FLOAT,
+    PETSC_COMM_WORLD
+  );
+
+  for (int r = 0; r < nproc; r++) {
+    const RealType* value = recvBuffer.data() + recvDispls[r];
+    traverse(intersect(box(previousStarts, r), currentBox), [&](int i, int j, int k) {
+      const int li = i - currentBox[0][0] + 2;
+      const int lj = j - currentBox[1][0] + 2;
+      const int lk = (dim == 3) ? k - currentBox[2][0] + 2 : 0;
+
+      to.getPressure().getScalar(li, lj, lk) = *value++;
+      std::copy(value, value + dim, to.getVelocity().getVector(li, lj, lk));
+      value += dim;
+    });
+  }
+}
+
+std::vector<int> ParallelManagers::LoadBalancer::partition(
+  const std::vector<RealType>& work, int parts, int minCells
+) {
+  const int layers = work.size();
+  if (parts < 1 || layers < parts * minCells) {
+    throw std::runtime_error("Too few layers of cells to partition them among the processors");
+  }
+
+  std::vector<RealType> prefix(layers + 1, 0.0);
+  for (int c = 0; c < layers; c++) {
+    prefix[c + 1] = prefix[c] + work[c];
+  }
+
+  // Every part ends at the layer boundary closest to its share of the work left by the previous parts, as long as it
+  // keeps at least minCells layers and leaves enough for the remaining parts
+  std::vector<int> cells(parts);
+  int              start = 0;
+  for (int q = 0; q < parts - 1; q++) {
+    const RealType target = prefix[start] + (prefix[layers] - prefix[start]) / (parts - q);
+    int            end    = std::lower_bound(prefix.begin() + start + 1, prefix.end(), target) - prefix.begin();
+    if (end > start + 1 && target - prefix[end - 1] < prefix[end] - target) {
+      end--;
+    }
+    end      = std::clamp(end, start + minCells, layers - (parts - q - 1) * minCells);
+    cells[q] = end - start;
+    start    = end;
+  }
+  cells[parts - 1] = layers - start;
+
+  return cells;
+}
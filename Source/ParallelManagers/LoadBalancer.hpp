@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../Definitions.hpp"
+#include "../FlowField.hpp"
+#include "../Parameters.hpp"
+#include "PetscParallelConfiguration.hpp"
+
+namespace ParallelManagers {
+
+  /** Class used to move the boundaries of the subdomains such that all processes get about the same work
+   *
+   * The work of a process is modelled as the number of its cells plus particleCost times the number of its particles.
+   * The subdomains keep forming a grid of processors: along each rebalanced axis, the layers of cells are split by
+   * their work summed over the other axes.
+   */
+  class LoadBalancer {
+  private:
+    Parameters&                 parameters_;    //! Reference to the parameters
+    PetscParallelConfiguration& configuration_; //! Configuration whose subdomains are moved
+
+    std::array<std::vector<int>, 3> balancedCells_; //! Cells of every processor along each axis found by balance()
+    std::array<std::vector<int>, 3> previousCells_; //! Cells of every processor before the last apply()
+
+  public:
+    LoadBalancer(Parameters& parameters, PetscParallelConfiguration& configuration);
+    ~LoadBalancer() = default;
+
+    /** Measures the imbalance of the work and computes balanced subdomains. Has to be called by all processes.
+     *
+     * @param layerCounts Number of particles of the subdomain in every global layer of cells along each axis
+     * @param particles Number of particles of the subdomain
+     * @return Whether the imbalance exceeds the threshold and the balanced subdomains differ from the current ones
+     */
+    bool balance(const std::array<std::vector<int>, 3>& layerCounts, int particles);
+
+    /** Moves the boundaries of the subdomains to the ones found by the last balance() */
+    void apply();
+
+    /** Copies the pressure and the velocity of the cells owned by the subdomains from a flow field built for the
+     * subdomains before the last apply() into one built for the current subdomains. Has to be called by all processes.
+     *
+     * The ghost layers of the new flow field are left to the parallel manager and the boundary iterators.
+     */
+    void redistribute(FlowField& from, FlowField& to) const;
+
+    /** Splits a row of layers into contiguous parts of about the same work
+     *
+     * @param work Work of every layer
+     * @param parts Number of parts
+     * @param minCells Minimum number of layers of every part
+     * @return Number of layers of every part
+     */
+    static std::vector<int> partition(const std::vector<RealType>& work, int parts, int minCells);
+  };
+
+} // namespace ParallelManagers
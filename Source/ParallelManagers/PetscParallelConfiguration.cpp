@@ -56,6 +56,19 @@ void ParallelManagers::PetscParallelConfiguration::locateNeighbors() {
     parameters_.parallel.backNb   = computeRankFromIndices(i, j, k + 1);
   }
 
+  for (int dk = -1; dk <= 1; dk++) {
+    for (int dj = -1; dj <= 1; dj++) {
+      for (int di = -1; di <= 1; di++) {
+        int& neighbour = parameters_.parallel.neighbours[(di + 1) + 3 * (dj + 1) + 9 * (dk + 1)];
+        if (parameters_.geometry.dim == 2 && dk != 0) {
+          neighbour = MPI_PROC_NULL;
+        } else {
+          neighbour = computeRankFromIndices(i + di, j + dj, k + dk);
+        }
+      }
+    }
+  }
+
   // If periodic boundaries declared, let the process itself deal with it, without communication.
   int rank;
   MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
@@ -101,15 +114,31 @@ void ParallelManagers::PetscParallelConfiguration::computeSizes() {
   geometrySizes[1] = parameters_.geometry.sizeY;
   geometrySizes[2] = parameters_.geometry.sizeZ;
 
+  // The cells are split evenly at first
+  std::array<std::vector<int>, 3> cells;
   for (int i = 0; i < dim; i++) {
+    cells[i].resize(parameters_.parallel.numProcessors[i]);
     for (int j = 0; j < parameters_.parallel.numProcessors[i]; j++) {
-      parameters_.parallel.sizes[i][j] = geometrySizes[i] / parameters_.parallel.numProcessors[i];
+      cells[i][j] = geometrySizes[i] / parameters_.parallel.numProcessors[i];
       if (j < geometrySizes[i] % parameters_.parallel.numProcessors[i]) {
-        parameters_.parallel.sizes[i][j]++;
+        cells[i][j]++;
       }
     }
   }
 
+  assignSizes(cells);
+}
+
+void ParallelManagers::PetscParallelConfiguration::assignSizes(const std::array<std::vector<int>, 3>& cells) {
+  int dim = parameters_.geometry.dim;
+  cells_  = cells;
+
+  for (int i = 0; i < dim; i++) {
+    for (int j = 0; j < parameters_.parallel.numProcessors[i]; j++) {
+      parameters_.parallel.sizes[i][j] = cells[i][j];
+    }
+  }
+
   // Locate the position of the first element of the subdomain. Useful for plotting later on.
   for (int i = 0; i < dim; i++) {
     parameters_.parallel.firstCorner[i] = 0;
@@ -135,6 +164,22 @@ void ParallelManagers::PetscParallelConfiguration::computeSizes() {
   }
 }
 
+void ParallelManagers::PetscParallelConfiguration::setSizes(const std::array<std::vector<int>, 3>& cells) {
+  const int geometrySizes[3] = {parameters_.geometry.sizeX, parameters_.geometry.sizeY, parameters_.geometry.sizeZ};
+  for (int i = 0; i < parameters_.geometry.dim; i++) {
+    if (static_cast<int>(cells[i].size()) != parameters_.parallel.numProcessors[i]
+        || std::accumulate(cells[i].begin(), cells[i].end(), 0) != geometrySizes[i]) {
+      throw std::runtime_error("The sizes of the subdomains do not match the processors and the geometry");
+    }
+  }
+
+  assignSizes(cells);
+}
+
+const std::array<std::vector<int>, 3>& ParallelManagers::PetscParallelConfiguration::getCells() const {
+  return cells_;
+}
+
 void ParallelManagers::PetscParallelConfiguration::freeSizes() {
   int dim = parameters_.geometry.dim;
 
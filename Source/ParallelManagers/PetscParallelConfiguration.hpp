@@ -9,9 +9,10 @@ namespace ParallelManagers {
    */
   class PetscParallelConfiguration {
   private:
-    Parameters& parameters_; //! Reference to the parameters
+    Parameters&                     parameters_; //! Reference to the parameters
+    std::array<std::vector<int>, 3> cells_;      //! Number of cells of every processor along each axis
 
-    /** Locates the six neighbors of the current process
+    /** Locates the six neighbors of the current process, and all neighbors across edges and corners
      */
     void locateNeighbors();
 
@@ -32,6 +33,9 @@ namespace ParallelManagers {
      */
     void computeSizes();
 
+    /** Sets the sizes of all subdomains, the local size and the first corner from the cells of every processor */
+    void assignSizes(const std::array<std::vector<int>, 3>& cells);
+
     /** Deletes the arrays allocated in the parameters. To be called in the destructor of this class.
      */
     void freeSizes();
@@ -39,6 +43,17 @@ namespace ParallelManagers {
   public:
     PetscParallelConfiguration(Parameters& parameters);
     ~PetscParallelConfiguration();
+
+    /** Moves the boundaries of the subdomains, keeping the processor grid
+     *
+     * Only the parameters are changed; fields and solvers built for the previous subdomain have to be rebuilt.
+     *
+     * @param cells Number of cells of every processor along each axis, which sum up to the size of the geometry
+     */
+    void setSizes(const std::array<std::vector<int>, 3>& cells);
+
+    /** Number of cells of every processor along each axis */
+    const std::array<std::vector<int>, 3>& getCells() const;
   };
 
 } // namespace ParallelManagers
@@ -116,10 +116,22 @@ public:
   int backNb   = MPI_PROC_NULL;
   //@}
 
+  //! Ranks of all subdomains touching this one, including edges and corners. The neighbour at offset (di, dj, dk)
+  //! is stored at (di + 1) + 3 * (dj + 1) + 9 * (dk + 1); MPI_PROC_NULL outside the domain, own rank in the centre.
+  int neighbours[27];
+
   int indices[3];     //! 3D indices to locate the array
   int localSize[3];   //! Size for the local flow field
   int firstCorner[3]; //! Position of the first element. Used for plotting.
 
+  //@brief Rebalancing of the subdomains by the work of their cells and particles
+  //@{
+  int      rebalanceInterval  = 0;   //! Time steps between two rebalancing attempts, 0 keeps the initial subdomains
+  int      rebalanceAxes      = 1;   //! Number of axes along which boundaries move, starting with x
+  RealType particleCost       = 1.0; //! Work of a particle relative to the work of a fluid cell
+  RealType imbalanceThreshold = 1.1; //! Ratio of the largest to the mean work of a rank which triggers rebalancing
+  //@}
+
 #ifdef ENABLE_PETSC
   PetscInt* sizes[3]; //! Arrays with the sizes of the blocks in each direction.
 #else
@@ -140,9 +152,24 @@ public:
 
 class ParticleParameters {
 public:
-  bool     enable         = false;
-  int      particleCount  = 0;
-  RealType injectInterval = 0.0;
+  bool     enable           = false;
+  int      particleCount    = 0;
+  RealType injectInterval   = 0.0;
+  int      sortInterval     = 0;     //! Time steps between sorting the particles by cell, 0 to never sort
+  int      maxParticles     = 0;     //! Particle budget of every subdomain, 0 for no limit
+  bool     dropOldest       = false; //! Whether injections beyond the budget replace the oldest particles, else skipped
+  int      integratorOrder  = 1;     //! Order of the Runge-Kutta integrator of the particles: 1 (Euler), 2 (Heun) or 4
+  RealType cfl              = 0.0;   //! Cells a particle may cross in one sub-step, 0 for one sub-step per time step
+  int      trajectoryStride = 0;     //! Time steps between two records of the trajectory logs, 0 to not record
+
+  std::string deposit; //! Weights of the particle concentration, "ngp" or "cic" (cloud in cell), empty for none
+
+  std::string statistics;              //! Comma-separated statistics written at VTK output: residence, means, hits
+  RealType    residenceBinWidth = 1.0; //! Bin width of the residence time histogram
+  int         residenceBins     = 20;  //! Number of bins of the residence time histogram
+
+  int         checkpointInterval = 0; //! Time steps between two particle checkpoints, 0 to not write any
+  std::string restart;                //! VTK prefix of the run whose particle checkpoints to restart from, if any
 };
 
 //@}
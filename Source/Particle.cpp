@@ -1,281 +1,48 @@
-#include "Particle.hpp"
-
-void Particle::calculateVelocity() {
-  if (parameters_.geometry.dim == 2) {
-    RealType* velocity1 = flowField_.getVelocity().getVector(index_[0], index_[1]);     //(i,j)
-    RealType* velocity2 = flowField_.getVelocity().getVector(index_[0] - 1, index_[1]); //(i-1,j)
-    RealType* velocity3 = flowField_.getVelocity().getVector(index_[0], index_[1] - 1); //(i,j-1)
-
-    RealType dx   = parameters_.meshsize->getDx(index_[0], index_[1]);
-    RealType dy   = parameters_.meshsize->getDy(index_[0], index_[1]);
-    RealType posX = parameters_.meshsize->getPosX(index_[0], index_[1]);
-    RealType posY = parameters_.meshsize->getPosY(index_[0], index_[1]);
-
-    velocity_[0] = velocity1[0] * (x_ - posX) / dx + velocity2[0] * (posX + dx - x_) / dx;
-    velocity_[1] = velocity1[1] * (y_ - posY) / dy + velocity3[1] * (posY + dy - y_) / dy;
-  } else {
-    RealType* velocity1 = flowField_.getVelocity().getVector(index_[0], index_[1], index_[2]);     //(i,j,k)
-    RealType* velocity2 = flowField_.getVelocity().getVector(index_[0] - 1, index_[1], index_[2]); //(i-1,j,k)
-    RealType* velocity3 = flowField_.getVelocity().getVector(index_[0], index_[1] - 1, index_[2]); //(i,j-1,k)
-    RealType* velocity4 = flowField_.getVelocity().getVector(index_[0], index_[1], index_[2] - 1); //(i,j,k-1)
-
-    RealType dx = parameters_.meshsize->getDx(index_[0], index_[1], index_[2]);
-    RealType dy = parameters_.meshsize->getDy(index_[0], index_[1], index_[2]);
-    RealType dz = parameters_.meshsize->getDz(index_[0], index_[1], index_[2]);
-
-    RealType posX = parameters_.meshsize->getPosX(index_[0], index_[1], index_[2]);
-    RealType posY = parameters_.meshsize->getPosY(index_[0], index_[1], index_[2]);
-    RealType posZ = parameters_.meshsize->getPosZ(index_[0], index_[1], index_[2]);
-
-    velocity_[0] = velocity1[0] * (x_ - posX) / dx + velocity2[0] * (posX + dx - x_) / dx;
-    velocity_[1] = velocity1[1] * (y_ - posY) / dy + velocity3[1] * (posY + dy - y_) / dy;
-    velocity_[2] = velocity1[2] * (z_ - posZ) / dz + velocity4[2] * (posZ + dz - z_) / dz;
-  }
-}
-
-Particle::Particle(const Particle& p) noexcept:
-  x_(p.x_),
-  y_(p.y_),
-  z_(p.z_),
-  velocity_(p.velocity_),
-  flowField_(p.flowField_),
-  parameters_(p.parameters_),
-  index_(p.index_) {}
+#include "StdAfx.hpp"
 
-Particle::Particle(Particle&& p) noexcept:
-  x_(p.x_),
-  y_(p.y_),
-  z_(p.z_),
-  velocity_(std::move(p.velocity_)),
-  flowField_(p.flowField_),
-  parameters_(p.parameters_),
-  index_(std::move(p.index_)) {}
-
-void Particle::serialize(RealType* buffer) noexcept {
-  if (parameters_.geometry.dim == 2) {
-    buffer[0] = x_;
-    buffer[1] = y_;
-    buffer[2] = velocity_[0];
-    buffer[3] = velocity_[1];
-    buffer[4] = index_[0];
-    buffer[5] = index_[1];
-  } else {
-    buffer[0] = x_;
-    buffer[1] = y_;
-    buffer[2] = z_;
-    buffer[3] = velocity_[0];
-    buffer[4] = velocity_[1];
-    buffer[5] = velocity_[2];
-    buffer[6] = index_[0];
-    buffer[7] = index_[1];
-    buffer[8] = index_[2];
-  }
-}
-
-Particle::Particle(RealType* serialized_data, FlowField& flowField, Parameters& parameters) noexcept:
-  flowField_(flowField),
-  parameters_(parameters) {
-  if (parameters_.geometry.dim == 2) {
-    x_           = serialized_data[0];
-    y_           = serialized_data[1];
-    velocity_[0] = serialized_data[2];
-    velocity_[1] = serialized_data[3];
-    index_[0]    = static_cast<int>(serialized_data[4] + 0.5);
-    index_[1]    = static_cast<int>(serialized_data[5] + 0.5);
-  } else {
-    x_           = serialized_data[0];
-    y_           = serialized_data[1];
-    z_           = serialized_data[2];
-    velocity_[0] = serialized_data[3];
-    velocity_[1] = serialized_data[4];
-    velocity_[2] = serialized_data[5];
-    index_[0]    = static_cast<int>(serialized_data[6] + 0.5);
-    index_[1]    = static_cast<int>(serialized_data[7] + 0.5);
-    index_[2]    = static_cast<int>(serialized_data[8] + 0.5);
-  }
-}
-
-Particle::Particle(
-  RealType x, RealType y, std::array<int, 3> index, FlowField& flowField, Parameters& parameters
-) noexcept:
-  x_(x),
-  y_(y),
-  index_(index),
-  flowField_(flowField),
-  parameters_(parameters) {}
+#include "Particle.hpp"
 
-Particle::Particle(
-  RealType x, RealType y, RealType z, std::array<int, 3> index, FlowField& flowField, Parameters& parameters
+template <int Dim>
+Particle<Dim>::Particle(
+  const ParticlePositionType position[Dim],
+  const RealType             velocity[Dim],
+  const int                  index[Dim],
+  int                        injection,
+  std::int64_t               id
 ) noexcept:
-  x_(x),
-  y_(y),
-  z_(z),
-  index_(index),
-  flowField_(flowField),
-  parameters_(parameters) {}
-
-RealType Particle::getX() { return x_; }
-RealType Particle::getY() { return y_; }
-RealType Particle::getZ() { return z_; }
-RealType Particle::getU() { return velocity_[0]; }
-RealType Particle::getV() { return velocity_[1]; }
-RealType Particle::getW() { return velocity_[2]; }
-int&     Particle::getI() { return index_[0]; }
-int&     Particle::getJ() { return index_[1]; }
-int&     Particle::getK() { return index_[2]; }
-
-void Particle::update(RealType dt) {
-  if (parameters_.geometry.dim == 3) {
-
-    calculateVelocity();
-    x_ += dt * velocity_[0];
-    y_ += dt * velocity_[1];
-    z_ += dt * velocity_[2];
-
-    // Updating x index
-    if (velocity_[0] >= 0.0) {
-      while (parameters_.meshsize->getPosX(index_[0], 0, 0) + parameters_.meshsize->getDx(index_[0], 0, 0) <= x_) {
-        index_[0]++;
-      }
-    } else {
-      while (parameters_.meshsize->getPosX(index_[0], 0, 0) >= x_) {
-        index_[0]--;
-      }
-    }
-
-    // Updating y index
-    if (velocity_[1] >= 0.0) {
-      while (parameters_.meshsize->getPosY(0, index_[1], 0) + parameters_.meshsize->getDy(0, index_[1], 0) <= y_) {
-        index_[1]++;
-      }
-    } else {
-      while (parameters_.meshsize->getPosY(0, index_[1], 0) >= y_) {
-        index_[1]--;
-      }
-    }
-
-    // Updating z index
-    if (velocity_[2] >= 0.0) {
-      while (parameters_.meshsize->getPosZ(0, 0, index_[2]) + parameters_.meshsize->getDz(0, 0, index_[2]) <= z_) {
-        index_[2]++;
-      }
-    } else {
-      while (parameters_.meshsize->getPosZ(0, 0, index_[2]) >= z_) {
-        index_[2]--;
-      }
-    }
-
-  } else {
-    calculateVelocity();
-    x_ += dt * velocity_[0];
-    y_ += dt * velocity_[1];
-
-    // Updating x index
-    if (velocity_[0] >= 0.0) {
-      while (parameters_.meshsize->getPosX(index_[0], 0) + parameters_.meshsize->getDx(index_[0], 0) <= x_) {
-        index_[0]++;
-      }
-    } else {
-      while (parameters_.meshsize->getPosX(index_[0], 0) >= x_) {
-        index_[0]--;
-      }
-    }
-
-    // Updating y index
-    if (velocity_[1] >= 0.0) {
-      while (parameters_.meshsize->getPosY(0, index_[1]) + parameters_.meshsize->getDy(0, index_[1]) <= y_) {
-        index_[1]++;
-      }
-    } else {
-      while (parameters_.meshsize->getPosY(0, index_[1]) >= y_) {
-        index_[1]--;
-      }
-    }
+  id_(id),
+  injection_(injection) {
+  for (int d = 0; d < Dim; d++) {
+    position_[d] = position[d];
+    velocity_[d] = velocity[d];
+    index_[d]    = index[d];
   }
-
-  applyBoundaryCondition();
 }
 
-void Particle::applyBoundaryCondition() {
-  /******* Cavity Case *******/
-  if (parameters_.simulation.scenario == "cavity") {
-
-    // Check if particle is left of left boundary
-    if (x_ < 0) {
-      wallCorrect(x_, 0.0, velocity_[0]);
-    }
-    // Check if particle is right of right boundary
-    else if (x_ > parameters_.geometry.lengthX) {
-      wallCorrect(x_, parameters_.geometry.lengthX, velocity_[0]);
-    }
-
-    // Check if particle is below bottom boundary
-    if (y_ < 0) {
-      wallCorrect(y_, 0.0, velocity_[1]);
-    }
-    // Check if particle is above top boundary
-    else if (y_ > parameters_.geometry.lengthY) {
-      wallCorrect(y_, parameters_.geometry.lengthY, velocity_[1]);
-    }
-
-    if (parameters_.geometry.dim == 3) {
-      if (z_ < 0) {
-        wallCorrect(z_, 0.0, velocity_[2]);
-      } else if (z_ > parameters_.geometry.lengthZ) {
-        wallCorrect(z_, parameters_.geometry.lengthZ, velocity_[2]);
-      }
-    }
-
-  }
-  /******* Channel Case ********/
-  else if (parameters_.bfStep.yRatio < 0) {
-    // Check if particle is below bottom boundary
-    if (y_ < 0) {
-      wallCorrect(y_, 0.0, velocity_[1]);
-    }
-    // Check if particle is above top boundary
-    else if (y_ > parameters_.geometry.lengthY) {
-      wallCorrect(y_, parameters_.geometry.lengthY, velocity_[1]);
-    }
-
-    if (parameters_.geometry.dim == 3) {
-      if (z_ < 0) {
-        wallCorrect(z_, 0.0, velocity_[2]);
-      } else if (z_ > parameters_.geometry.lengthZ) {
-        wallCorrect(z_, parameters_.geometry.lengthZ, velocity_[2]);
-      }
-    }
-  }
-  /******* BFS Case ********/
-  else {
-    RealType stepLengthX = parameters_.geometry.lengthX * parameters_.bfStep.xRatio;
-    RealType stepLengthY = parameters_.geometry.lengthY * parameters_.bfStep.yRatio;
-    // Check if particle is inside the step
-    if (x_ < stepLengthX && y_ < stepLengthY) {
-      if (velocity_[0] < 0)
-        wallCorrect(x_, stepLengthX, velocity_[0]);
-      if (velocity_[1] < 0)
-        wallCorrect(y_, stepLengthY, velocity_[1]);
-    }
-    // Check if particle is above top boundary
-    else if (y_ > parameters_.geometry.lengthY) {
-      wallCorrect(y_, parameters_.geometry.lengthY, velocity_[1]);
-    }
-    // Check if particle is below bottom boundary
-    else if (y_ < 0) {
-      wallCorrect(y_, 0.0, velocity_[1]);
-    }
-    if (parameters_.geometry.dim == 3) {
-      if (z_ < 0) {
-        wallCorrect(z_, 0.0, velocity_[2]);
-      } else if (z_ > parameters_.geometry.lengthZ) {
-        wallCorrect(z_, parameters_.geometry.lengthZ, velocity_[2]);
-      }
-    }
-  }
+template <int Dim>
+MPI_Datatype Particle<Dim>::createMPIDatatype() {
+  static_assert(std::is_standard_layout_v<Particle> && std::is_trivially_copyable_v<Particle>);
+
+  const int          blockLengths[5]  = {Dim, Dim, 1, Dim, 1};
+  const MPI_Aint     displacements[5] = {
+    offsetof(Particle, position_),
+    offsetof(Particle, velocity_),
+    offsetof(Particle, id_),
+    offsetof(Particle, index_),
+    offsetof(Particle, injection_)};
+  const MPI_Datatype types[5] = {PARTICLE_MPI_POSITION, MY_MPI_FLOAT, MPI_INT64_T, MPI_INT32_T, MPI_INT32_T};
+
+  MPI_Datatype record;
+  MPI_Datatype particleType;
+  MPI_Type_create_struct(5, blockLengths, displacements, types, &record);
+
+  // Consecutive particles in a buffer are sizeof(Particle) apart
+  MPI_Type_create_resized(record, 0, sizeof(Particle), &particleType);
+  MPI_Type_commit(&particleType);
+  MPI_Type_free(&record);
+
+  return particleType;
 }
 
-inline void Particle::wallCorrect(RealType& x, RealType limitX, RealType& velocity) {
-  x        = 2 * limitX - x;
-  velocity = -velocity;
-}
\ No newline at end of file
+template class Particle<2>;
+template class Particle<3>;
@@ -3,38 +3,50 @@
 #include "StdAfx.hpp"
 
 #include "Definitions.hpp"
-#include "FlowField.hpp"
 
+// Datatype of the coordinates of migrating particles. With compact positions, a particle is sent with its position
+// inside the cell it is in, which single precision resolves far below the mesh size.
+#ifdef ENABLE_COMPACT_PARTICLE_POSITIONS
+using ParticlePositionType = float;
+#define PARTICLE_MPI_POSITION MPI_FLOAT
+#else
+using ParticlePositionType = RealType;
+#define PARTICLE_MPI_POSITION MY_MPI_FLOAT
+#endif
+
+/** A single tracer particle, detached from the container it lives in
+ *
+ * This is the record in which particles are sent to other subdomains. Inside a subdomain, the particles are stored in
+ * a ParticleContainer. Only the Dim components of the domain are stored.
+ */
+template <int Dim>
 class Particle {
-private:
-  RealType                x_, y_, z_; // coordinates
-  std::array<RealType, 3> velocity_;
-  FlowField&              flowField_;
-  Parameters&             parameters_;
-  std::array<int, 3>      index_; // index of cell particle is in
+  static_assert(Dim == 2 || Dim == 3, "Particles only exist in 2D and 3D");
 
-  void        calculateVelocity();                                           // calculate particle velocity
-  void        applyBoundaryCondition();                                      // apply boundary condition on particle
-  inline void wallCorrect(RealType& x, RealType xLimit, RealType& velocity); // helper function for boundary conditions
+private:
+  ParticlePositionType position_[Dim]; //! Coordinates, or offset inside the cell with compact positions
+  RealType             velocity_[Dim];
+  std::int64_t         id_;         //! Identifier of the particle, unique in the whole domain
+  std::int32_t         index_[Dim]; //! Index of the cell the particle is in
+  std::int32_t         injection_;  //! Number of the injection the particle was seeded in
 
 public:
-  Particle(RealType x, RealType y, std::array<int, 3> index, FlowField& flowField_, Parameters& parameters) noexcept;
+  Particle() = default;
   Particle(
-    RealType x, RealType y, RealType z, std::array<int, 3> index, FlowField& flowField_, Parameters& parameters
+    const ParticlePositionType position[Dim],
+    const RealType             velocity[Dim],
+    const int                  index[Dim],
+    int                        injection,
+    std::int64_t               id
   ) noexcept;
-  RealType getX();
-  RealType getY();
-  RealType getZ();
-  RealType getU();
-  RealType getV();
-  RealType getW();
-  int&     getI();
-  int&     getJ();
-  int&     getK();
-  Particle(const Particle& p) noexcept;
-  Particle(Particle&& p) noexcept;
-  void serialize(RealType* buffer) noexcept;
-  Particle(RealType* serialized_data, FlowField& flowField_, Parameters& parameters) noexcept;
-
-  void update(RealType dt);
-};
\ No newline at end of file
+
+  ParticlePositionType getPosition(int d) const { return position_[d]; }
+  RealType             getVelocity(int d) const { return velocity_[d]; }
+  std::int32_t&        getIndex(int d) { return index_[d]; }
+  std::int32_t         getIndex(int d) const { return index_[d]; }
+  std::int32_t         getInjection() const { return injection_; }
+  std::int64_t         getId() const { return id_; }
+
+  /** Creates and commits the MPI datatype of a particle, to be freed by the caller */
+  static MPI_Datatype createMPIDatatype();
+};
@@ -0,0 +1,93 @@
+#include "StdAfx.hpp"
+
+#include "ParticleCheckpoint.hpp"
+
+std::string ParticleCheckpoint::getFileName(const std::string& prefix, int rank, std::int64_t timeSteps) {
+  return "Output/" + prefix + "/" + prefix + "checkpoint." + std::to_string(rank) + "." + std::to_string(timeSteps)
+         + ".bin";
+}
+
+std::string ParticleCheckpoint::getCommitName(const std::string& prefix) {
+  return "Output/" + prefix + "/" + prefix + "checkpoint.commit";
+}
+
+void ParticleCheckpoint::write(const std::string& fileName, Checkpoint& checkpoint) {
+  Header& header = checkpoint.header;
+  std::copy(std::begin(MAGIC), std::end(MAGIC), header.magic);
+  header.version    = VERSION;
+  header.injections = checkpoint.injectionTimes.size();
+  header.particles  = checkpoint.records.size();
+  header.sums       = checkpoint.sums.size();
+
+  const std::string temporaryName = fileName + ".tmp";
+  {
+    std::ofstream file(temporaryName, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(
+      reinterpret_cast<const char*>(checkpoint.injectionTimes.data()), checkpoint.injectionTimes.size() * sizeof(double)
+    );
+    file.write(reinterpret_cast<const char*>(checkpoint.sums.data()), checkpoint.sums.size() * sizeof(double));
+    file.write(reinterpret_cast<const char*>(checkpoint.records.data()), checkpoint.records.size() * sizeof(Record));
+    file.close();
+    if (!file) {
+      spdlog::error("Cannot write the particle checkpoint {}", temporaryName);
+      throw std::runtime_error("Error while writing the particle checkpoint");
+    }
+  }
+
+  // Renaming within a file system replaces the previous checkpoint in one step
+  std::filesystem::rename(temporaryName, fileName);
+}
+
+ParticleCheckpoint::Checkpoint ParticleCheckpoint::read(const std::string& fileName, bool withRecords) {
+  std::ifstream file(fileName, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Cannot open the particle checkpoint " + fileName);
+  }
+
+  Checkpoint checkpoint;
+  Header&    header = checkpoint.header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(Header))
+      || !std::equal(std::begin(MAGIC), std::end(MAGIC), header.magic) || header.version != VERSION) {
+    throw std::runtime_error(fileName + " is not a particle checkpoint");
+  }
+
+  checkpoint.injectionTimes.resize(header.injections);
+  checkpoint.sums.resize(header.sums);
+  checkpoint.records.resize(withRecords ? header.particles : 0);
+  file.read(
+    reinterpret_cast<char*>(checkpoint.injectionTimes.data()), checkpoint.injectionTimes.size() * sizeof(double)
+  );
+  file.read(reinterpret_cast<char*>(checkpoint.sums.data()), checkpoint.sums.size() * sizeof(double));
+  file.read(reinterpret_cast<char*>(checkpoint.records.data()), checkpoint.records.size() * sizeof(Record));
+  if (!file) {
+    throw std::runtime_error("The particle checkpoint " + fileName + " is truncated");
+  }
+
+  return checkpoint;
+}
+
+void ParticleCheckpoint::commit(const std::string& prefix, std::int64_t timeSteps) {
+  const std::string fileName      = getCommitName(prefix);
+  const std::string temporaryName = fileName + ".tmp";
+  {
+    std::ofstream file(temporaryName, std::ios::trunc);
+    file << timeSteps << std::endl;
+    file.close();
+    if (!file) {
+      spdlog::error("Cannot write the particle checkpoint commit {}", temporaryName);
+      throw std::runtime_error("Error while committing the particle checkpoints");
+    }
+  }
+  std::filesystem::rename(temporaryName, fileName);
+}
+
+std::int64_t ParticleCheckpoint::readCommit(const std::string& prefix) {
+  const std::string fileName = getCommitName(prefix);
+  std::ifstream     file(fileName);
+  std::int64_t      timeSteps;
+  if (!(file >> timeSteps)) {
+    throw std::runtime_error("No committed particle checkpoints in " + fileName);
+  }
+  return timeSteps;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "StdAfx.hpp"
+
+#include "Definitions.hpp"
+
+/** Binary checkpoints of the tracer particles
+ *
+ * Every rank writes the particles it owns to its own checkpoint: a ParticleCheckpoint::Header, the time of every
+ * injection, the sums of the particle statistics and the particle Records. Cells are given in the global numbering, so
+ * that a run with a different number of ranks can restart from the checkpoint. Checkpoints are written in the byte
+ * order of the machine.
+ *
+ * The checkpoints of a time step form a generation, which is committed once all ranks have written theirs. A run is
+ * restarted from the last committed generation, so that a run which is killed while some ranks are still writing
+ * leaves a complete set of checkpoints behind.
+ */
+namespace ParticleCheckpoint {
+
+  constexpr char         MAGIC[8] = {'N', 'S', 'E', 'O', 'F', 'C', 'K', 'P'};
+  constexpr std::int32_t VERSION  = 1;
+
+  struct Header {
+    char         magic[8];
+    std::int32_t version;
+    std::int32_t dim;        //! Dimension of the simulation which wrote the checkpoint
+    std::int32_t ranks;      //! Number of ranks which wrote a checkpoint each
+    std::int32_t injections; //! Number of injections so far
+    std::int64_t timeSteps;  //! Time step of the checkpoint
+    std::int64_t particles;  //! Number of particle records
+    std::int64_t sums;       //! Number of sums of the particle statistics
+    double       time;       //! Time of the checkpoint
+    double       timeInject; //! Time of the next injection
+  };
+
+  struct Record {
+    std::int64_t id;
+    std::int32_t injection;
+    std::int32_t index[3]; //! Global index of the cell of the particle
+    double       position[3];
+    double       velocity[3];
+  };
+
+  /** Contents of the checkpoint of one rank */
+  struct Checkpoint {
+    Header              header;
+    std::vector<Record> records;
+    std::vector<double> injectionTimes;
+    std::vector<double> sums;
+  };
+
+  /** State of the time loop at a checkpoint */
+  struct State {
+    int      timeSteps;
+    RealType time;
+    RealType timeInject;
+  };
+
+  /** Name of the checkpoint of a rank at a time step, in the output folder of the given VTK prefix */
+  std::string getFileName(const std::string& prefix, int rank, std::int64_t timeSteps);
+
+  /** Name of the file which holds the time step of the last committed generation */
+  std::string getCommitName(const std::string& prefix);
+
+  /** Writes a checkpoint atomically
+   *
+   * The checkpoint is written to a temporary file, which then replaces the previous checkpoint, so that a run which is
+   * killed while writing leaves the previous checkpoint intact. The header fields magic, version, injections,
+   * particles and sums are filled in from the contents.
+   */
+  void write(const std::string& fileName, Checkpoint& checkpoint);
+
+  /** Reads a checkpoint, optionally without its particle records */
+  Checkpoint read(const std::string& fileName, bool withRecords = true);
+
+  /** Commits the generation of the given time step atomically. To be called once all ranks have written their
+   * checkpoint of the time step.
+   */
+  void commit(const std::string& prefix, std::int64_t timeSteps);
+
+  /** Returns the time step of the last committed generation */
+  std::int64_t readCommit(const std::string& prefix);
+
+} // namespace ParticleCheckpoint
@@ -0,0 +1,153 @@
+#include "StdAfx.hpp"
+
+#include "ParticleContainer.hpp"
+
+#include "Assertion.hpp"
+
+template <int Dim>
+void ParticleContainer<Dim>::reserve(int capacity) {
+  for (int d = 0; d < Dim; d++) {
+    position_[d].reserve(capacity);
+    velocity_[d].reserve(capacity);
+    index_[d].reserve(capacity);
+  }
+  injection_.reserve(capacity);
+  id_.reserve(capacity);
+
+  // sortByCell() swaps the arrays with the buffers, which hence need the same capacity
+  keys_.reserve(capacity);
+  order_.reserve(capacity);
+  realBuffer_.reserve(capacity);
+  intBuffer_.reserve(capacity);
+  idBuffer_.reserve(capacity);
+}
+
+template <int Dim>
+void ParticleContainer<Dim>::clear() {
+  for (int d = 0; d < Dim; d++) {
+    position_[d].clear();
+    velocity_[d].clear();
+    index_[d].clear();
+  }
+  injection_.clear();
+  id_.clear();
+}
+
+template <int Dim>
+int ParticleContainer<Dim>::add(
+  const std::array<RealType, Dim>& position, const std::array<int, Dim>& index, int injection, std::int64_t id
+) {
+  return add(position, std::array<RealType, Dim>{}, index, injection, id);
+}
+
+template <int Dim>
+int ParticleContainer<Dim>::add(
+  const std::array<RealType, Dim>& position,
+  const std::array<RealType, Dim>& velocity,
+  const std::array<int, Dim>&      index,
+  int                              injection,
+  std::int64_t                     id
+) {
+  for (int d = 0; d < Dim; d++) {
+    position_[d].push_back(position[d]);
+    velocity_[d].push_back(velocity[d]);
+    index_[d].push_back(index[d]);
+  }
+  injection_.push_back(injection);
+  id_.push_back(id);
+  return size() - 1;
+}
+
+template <int Dim>
+void ParticleContainer<Dim>::append(const ParticleContainer& particles, int injection, std::int64_t idOffset) {
+  for (int d = 0; d < Dim; d++) {
+    position_[d].insert(position_[d].end(), particles.position_[d].begin(), particles.position_[d].end());
+    velocity_[d].insert(velocity_[d].end(), particles.velocity_[d].begin(), particles.velocity_[d].end());
+    index_[d].insert(index_[d].end(), particles.index_[d].begin(), particles.index_[d].end());
+  }
+  injection_.resize(injection_.size() + particles.size(), injection);
+  for (const std::int64_t id : particles.id_) {
+    id_.push_back(id + idOffset);
+  }
+}
+
+template <int Dim>
+void ParticleContainer<Dim>::remove(int p) {
+  ASSERTION(p >= 0 && p < size());
+  const int last = size() - 1;
+  for (int d = 0; d < Dim; d++) {
+    position_[d][p] = position_[d][last];
+    velocity_[d][p] = velocity_[d][last];
+    index_[d][p]    = index_[d][last];
+    position_[d].pop_back();
+    velocity_[d].pop_back();
+    index_[d].pop_back();
+  }
+  injection_[p] = injection_[last];
+  id_[p]        = id_[last];
+  injection_.pop_back();
+  id_.pop_back();
+}
+
+template <int Dim>
+void ParticleContainer<Dim>::truncate(int size) {
+  ASSERTION(size >= 0 && size <= this->size());
+  for (int d = 0; d < Dim; d++) {
+    position_[d].resize(size);
+    velocity_[d].resize(size);
+    index_[d].resize(size);
+  }
+  injection_.resize(size);
+  id_.resize(size);
+}
+
+// Rearranges values such that position n holds the value at position order[n]
+template <class T>
+static void permute(AlignedVector<T>& values, const std::vector<int>& order, AlignedVector<T>& buffer) {
+  buffer.resize(order.size());
+  for (std::size_t n = 0; n < order.size(); n++) {
+    buffer[n] = values[order[n]];
+  }
+  values.swap(buffer);
+}
+
+template <int Dim>
+void ParticleContainer<Dim>::sortByCell(const std::array<int, Dim>& cells) {
+  const int numberOfParticles = size();
+  int       numberOfCells     = 1;
+  for (int d = 0; d < Dim; d++) {
+    numberOfCells *= cells[d];
+  }
+
+  keys_.resize(numberOfParticles);
+  for (int p = 0; p < numberOfParticles; p++) {
+    int key = 0;
+    for (int d = Dim - 1; d >= 0; d--) {
+      key = key * cells[d] + std::clamp(index_[d][p], 0, cells[d] - 1);
+    }
+    keys_[p] = key;
+  }
+
+  // Count the particles per cell, turn the counts into offsets and place every particle behind the previous ones of
+  // its cell
+  cellOffsets_.assign(numberOfCells + 1, 0);
+  for (int p = 0; p < numberOfParticles; p++) {
+    cellOffsets_[keys_[p] + 1]++;
+  }
+  std::partial_sum(cellOffsets_.begin(), cellOffsets_.end(), cellOffsets_.begin());
+  order_.resize(numberOfParticles);
+  for (int p = 0; p < numberOfParticles; p++) {
+    order_[cellOffsets_[keys_[p]]++] = p;
+  }
+
+  for (int d = 0; d < Dim; d++) {
+    permute(position_[d], order_, realBuffer_);
+    permute(velocity_[d], order_, realBuffer_);
+    permute(index_[d], order_, intBuffer_);
+  }
+  permute(injection_, order_, intBuffer_);
+  permute(id_, order_, idBuffer_);
+}
+
+template class ParticleContainer<2>;
+template class ParticleContainer<3>;
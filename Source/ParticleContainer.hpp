@@ -0,0 +1,130 @@
+#pragma once
+
+#include "AlignedAllocator.hpp"
+#include "Definitions.hpp"
+
+/** Structure-of-arrays storage for the tracer particles of a subdomain
+ *
+ * Every particle attribute (coordinates, velocity, index of the cell the particle is in, ...) is kept in its own
+ * contiguous, cache-line aligned array, so that the advection loop streams through memory instead of chasing list
+ * nodes. A particle is addressed by its position p in the arrays. Particles are removed by moving the last particle
+ * into the freed slot (swap-and-pop), hence removing a particle changes the position of the last one. Only the Dim
+ * components of the domain are stored.
+ */
+template <int Dim>
+class ParticleContainer {
+  static_assert(Dim == 2 || Dim == 3, "Particles only exist in 2D and 3D");
+
+private:
+  std::array<AlignedVector<RealType>, Dim> position_; //! Coordinates x, y (, z)
+  std::array<AlignedVector<RealType>, Dim> velocity_; //! Velocities u, v (, w)
+  std::array<AlignedVector<int>, Dim>      index_;    //! Index i, j (, k) of the cell the particle is in
+  AlignedVector<int>                       injection_; //! Number of the injection the particle was seeded in
+  AlignedVector<std::int64_t>              id_;        //! Identifier of the particle, unique in the whole domain
+
+  // Buffers of sortByCell(), kept to avoid allocations
+  std::vector<int>            keys_;        //! Cell of every particle
+  std::vector<int>            cellOffsets_; //! First position of the particles of every cell after sorting
+  std::vector<int>            order_;       //! Previous position of the particle at every position after sorting
+  AlignedVector<RealType>     realBuffer_;
+  AlignedVector<int>          intBuffer_;
+  AlignedVector<std::int64_t> idBuffer_;
+
+public:
+  ParticleContainer()  = default;
+  ~ParticleContainer() = default;
+
+  /** Returns the number of stored particles */
+  int size() const { return static_cast<int>(position_[0].size()); }
+
+  bool empty() const { return position_[0].empty(); }
+
+  /** Preallocates storage for the given number of particles */
+  void reserve(int capacity);
+
+  /** Removes all particles, keeping the allocated storage */
+  void clear();
+
+  /** Appends a particle at rest and returns its position in the arrays
+   *
+   * @param position Coordinates of the particle
+   * @param index Index of the cell containing the particle
+   * @param injection Number of the injection the particle is seeded in
+   * @param id Identifier of the particle
+   */
+  int add(const std::array<RealType, Dim>& position, const std::array<int, Dim>& index, int injection, std::int64_t id);
+
+  /** Appends a particle together with its velocity and returns its position in the arrays */
+  int add(
+    const std::array<RealType, Dim>& position,
+    const std::array<RealType, Dim>& velocity,
+    const std::array<int, Dim>&      index,
+    int                              injection,
+    std::int64_t                     id
+  );
+
+  /** Appends all particles of another container in one go
+   *
+   * @param injection Number of the injection the appended particles are seeded in
+   * @param idOffset Offset added to the identifiers of the appended particles
+   */
+  void append(const ParticleContainer& particles, int injection, std::int64_t idOffset);
+
+  /** Removes particle p by moving the last particle into its slot
+   *
+   * When iterating over the particles while removing some of them, position p has to be revisited afterwards.
+   */
+  void remove(int p);
+
+  /** Removes all particles from position size on, keeping the allocated storage */
+  void truncate(int size);
+
+  /** Orders the particles by the cell they are in, with the cell index i running fastest
+   *
+   * Particles which share a cell end up next to each other and keep their relative order (counting sort). Positions
+   * of particles obtained before the sort are invalidated.
+   *
+   * @param cells Number of cells of the local field along each axis. Particles outside of it are sorted to the
+   * nearest cell.
+   */
+  void sortByCell(const std::array<int, Dim>& cells);
+
+  RealType& getX(int p) { return position_[0][p]; }
+  RealType& getY(int p) { return position_[1][p]; }
+  RealType& getZ(int p)
+    requires(Dim == 3)
+  {
+    return position_[2][p];
+  }
+  RealType& getU(int p) { return velocity_[0][p]; }
+  RealType& getV(int p) { return velocity_[1][p]; }
+  RealType& getW(int p)
+    requires(Dim == 3)
+  {
+    return velocity_[2][p];
+  }
+  int& getI(int p) { return index_[0][p]; }
+  int& getJ(int p) { return index_[1][p]; }
+  int& getK(int p)
+    requires(Dim == 3)
+  {
+    return index_[2][p];
+  }
+  int&          getInjection(int p) { return injection_[p]; }
+  std::int64_t& getId(int p) { return id_[p]; }
+
+  /** Raw access to the arrays of a component, to be used in the particle kernels
+   *
+   * @param d Component (0: x, 1: y, 2: z), less than Dim
+   */
+  RealType*           getPositions(int d) { return position_[d].data(); }
+  RealType*           getVelocities(int d) { return velocity_[d].data(); }
+  int*                getIndices(int d) { return index_[d].data(); }
+  int*                getInjections() { return injection_.data(); }
+  std::int64_t*       getIds() { return id_.data(); }
+  const RealType*     getPositions(int d) const { return position_[d].data(); }
+  const RealType*     getVelocities(int d) const { return velocity_[d].data(); }
+  const int*          getIndices(int d) const { return index_[d].data(); }
+  const int*          getInjections() const { return injection_.data(); }
+  const std::int64_t* getIds() const { return id_.data(); }
+};
@@ -1,646 +1,1326 @@
 #include "ParticleSimulation.hpp"
 
-ParticleSimulation::ParticleSimulation(Parameters& parameters, FlowField& flowField):
+#include "FlowFieldCheckpoint.hpp"
+#include "ParticleTrajectory.hpp"
+
+// Number of particles whose velocities are interpolated in one go
+static constexpr int PARTICLE_BATCH_SIZE = 256;
+
+template <int Dim>
+ParticleSimulation<Dim>::ParticleSimulation(Parameters& parameters, FlowField& flowField):
   parameters_(parameters),
-  flowField_(flowField) {}
+  flowField_(flowField),
+  stepsSinceSort_(0),
+  injections_(0),
+  time_(0.0),
+  checkpointTimeSteps_(-1),
+  cloudInCell_(parameters.particles.deposit == "cic"),
+  retainVelocity_(parameters.particles.integratorOrder > 1 || parameters.particles.cfl > 0.0),
+  neighbourhood_(MPI_COMM_NULL),
+  particleType_(MPI_DATATYPE_NULL),
+  requests_{MPI_REQUEST_NULL, MPI_REQUEST_NULL},
+  exchanges_(0),
+  communicating_(false),
+  statistics_(ParticleStatistics::create(parameters.particles)) {
+
+  if (parameters.geometry.dim != Dim) {
+    throw std::runtime_error("The particle simulation does not match the dimension of the geometry");
+  }
 
-void ParticleSimulation::initializeParticles() {
-  // Number of particles in each direction (2D: y - 3D: y & z)
-  const int particleCount = parameters_.particles.particleCount;
-  const int dim           = parameters_.geometry.dim;
+  const std::string& deposit = parameters.particles.deposit;
+  if (!deposit.empty() && deposit != "ngp" && deposit != "cic") {
+    throw std::runtime_error("Unknown particle deposit " + deposit + "! Currently supported: ngp, cic");
+  }
 
-  const RealType lengthY = (parameters_.bfStep.yRatio <= 0.0)
-                             ? parameters_.geometry.lengthY
-                             : parameters_.geometry.lengthY * (1 - parameters_.bfStep.yRatio);
-  const RealType lengthZ = parameters_.geometry.lengthZ;
+  const int order = parameters.particles.integratorOrder;
+  if (order != 1 && order != 2 && order != 4) {
+    throw std::runtime_error("Particle integrators are only available of order 1, 2 and 4");
+  }
 
-  // Assuming uniform spacing between particles
-  double spacingY = lengthY / (particleCount + 1);
-  double spacingZ = lengthZ / (particleCount + 1);
-
-  RealType x = parameters_.meshsize->getDx(2, 0) / 2;
-  RealType y = (parameters_.bfStep.yRatio >= 0) ? (parameters_.bfStep.yRatio * parameters_.geometry.lengthY) : 0;
-  std::array<int, 3> index = {2, 0, 0};
-
-  if (parameters_.simulation.scenario == "cavity") {
-    x = (parameters_.geometry.lengthX + parameters_.meshsize->getDx(2, 1)) / 2.0;
-    if (parameters_.meshsize->getPosX(2, 0) <= x && x <= parameters_.meshsize->getPosX(parameters_.parallel.localSize[0] + 2, 0)) {
-      int i = 2;
-      while (parameters_.meshsize->getPosX(i, 0) + parameters_.meshsize->getDx(i, 0) / 2 <= x) {
-        i++;
-      }
-      index[0] = i;
-    } else {
-      index[0] = -1;
+  // Resolve the scenario into the walls of the domain once. Inflow and outflow boundaries let the particles leave,
+  // periodic boundaries are not supported for particles and let them leave as well.
+  const std::string& scenario = parameters.simulation.scenario;
+  const bool         closed   = (scenario == "cavity" || scenario == "channel" || scenario == "pressure-channel");
+  for (int d = 0; d < Dim; d++) {
+    walls_[d][0] = walls_[d][1] = closed && (d > 0 || scenario == "cavity");
+  }
+  lengths_[0] = parameters.geometry.lengthX;
+  lengths_[1] = parameters.geometry.lengthY;
+  if constexpr (Dim == 3) {
+    lengths_[2] = parameters.geometry.lengthZ;
+  }
+
+  // The storage for the particle budget is allocated once, slots of removed particles are reused by later ones
+  if (parameters.particles.maxParticles > 0) {
+    particles_.reserve(parameters.particles.maxParticles);
+  }
+
+  // The mesh size only depends on the index along the respective axis
+  for (int d = 0; d < Dim; d++) {
+    const int cells = (d == 0) ? flowField.getCellsX() : (d == 1) ? flowField.getCellsY() : flowField.getCellsZ();
+    cellStarts_[d].resize(cells);
+    inverseSpacings_[d].resize(cells);
+    for (int c = 0; c < cells; c++) {
+      cellStarts_[d][c]      = getCellStart(d, c);
+      inverseSpacings_[d][c] = 1.0
+                               / ((d == 0)   ? parameters.meshsize->getDx(c, 0, 0)
+                                  : (d == 1) ? parameters.meshsize->getDy(0, c, 0)
+                                             : parameters.meshsize->getDz(0, 0, c));
     }
   }
 
-  ASSERTION(dim == 2 || dim == 3);
+  computeSeeds();
+  if (retainVelocity_) {
+    retainVelocity();
+  }
+}
 
-  if (dim == 2) {
-    // Uniform distribution of the particles in the y-direction
-    // Avoid having particles at exactly the bottom and top walls
-    int j = 0;
-    for (int p = 0; p < particleCount; p++) {
-      y += spacingY;
-      while (parameters_.meshsize->getPosY(0, j) + parameters_.meshsize->getDy(0, j) <= y) {
-        j++;
+template <int Dim>
+ParticleSimulation<Dim>::~ParticleSimulation() {
+  // An exchange is only left pending when unwinding from an error, the owner completes it before deleting otherwise.
+  // The sizes are posted by every neighbour in beginCommunicateParticles(), the distant particles are abandoned.
+  if (communicating_) {
+    MPI_Wait(&requests_[0], MPI_STATUS_IGNORE);
+    for (MPI_Request& request : distantRequests_) {
+      if (request != MPI_REQUEST_NULL) {
+        MPI_Request_free(&request);
       }
-      index[1] = j;
-      if (x > parameters_.meshsize->getPosX(2, 0)) {
-        if (index[0] >= 2 && index[0] < flowField_.getCellsX() - 1 && index[1] >= 2 && index[1] < flowField_.getCellsY() - 1) {
-          particles_.push_front(Particle(x, y, index, flowField_, parameters_));
-        }
+    }
+  }
+  if (neighbourhood_ != MPI_COMM_NULL) {
+    MPI_Type_free(&particleType_);
+    MPI_Comm_free(&neighbourhood_);
+  }
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::interpolateVelocities(
+  int                                     count,
+  const std::array<const RealType*, Dim>& positions,
+  const std::array<const int*, Dim>&      indices,
+  RealType                                theta,
+  const std::array<RealType*, Dim>&       velocities
+) {
+  VectorField&          velocity = flowField_.getVelocity();
+  const RealType* const current  = velocity.getData();
+  const RealType* const previous = retainVelocity_ ? previousVelocity_.data() : current;
+
+  // Distance between neighbouring cells in the field array along each axis
+  const int strides[3] = {Dim, Dim * velocity.getPitch(), Dim * velocity.getPitch() * velocity.getNy()};
+
+  const RealType* starts[Dim];
+  const RealType* inverseSpacings[Dim];
+  for (int d = 0; d < Dim; d++) {
+    starts[d]          = cellStarts_[d].data();
+    inverseSpacings[d] = inverseSpacings_[d].data();
+  }
+
+  // Velocities are stored on the right/top/back face of a cell, so the two faces enclosing a particle are the ones of
+  // its cell and of the previous cell along axis d
+  const auto interpolate = [&](int p, int d, int cell, auto blend) {
+    const int      index = indices[d][p];
+    const RealType r     = (positions[d][p] - starts[d][index]) * inverseSpacings[d][index];
+    velocities[d][p]     = current[cell + d] * r + current[cell - strides[d] + d] * (1.0 - r);
+    if constexpr (decltype(blend)::value) {
+      const RealType before = previous[cell + d] * r + previous[cell - strides[d] + d] * (1.0 - r);
+      velocities[d][p]      = before + theta * (velocities[d][p] - before);
+    }
+  };
+
+  // The components are spelled out, as loops over them would keep the compiler from vectorising over the particles
+  const auto kernel = [&](auto blend) {
+#pragma omp simd
+    for (int p = 0; p < count; p++) {
+      if constexpr (Dim == 2) {
+        const int cell = indices[0][p] * strides[0] + indices[1][p] * strides[1];
+        interpolate(p, 0, cell, blend);
+        interpolate(p, 1, cell, blend);
+      } else {
+        const int cell = indices[0][p] * strides[0] + indices[1][p] * strides[1] + indices[2][p] * strides[2];
+        interpolate(p, 0, cell, blend);
+        interpolate(p, 1, cell, blend);
+        interpolate(p, 2, cell, blend);
       }
     }
+  };
+
+  if (previous == current || theta == 1.0) {
+    kernel(std::false_type());
   } else {
-    RealType z;
-
-    // Uniform distributution of the particles in the YZ-direction
-    // Total of particleCount*particleCount particles in the YZ-plane
-    // Avoid having particles at exactly the bottom, top, front, and back walls
-    int j = 0;
-    int k = 0;
-    for (int py = 0; py < particleCount; py++) {
-      k = 0;
-      y += spacingY;
-      z = 0;
-      while (parameters_.meshsize->getPosY(0, j, k) + parameters_.meshsize->getDy(0, j, k) <= y) {
-        j++;
+    kernel(std::true_type());
+  }
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::integrateParticles(int first, int last, RealType dt, Hits& hits) {
+  const int      count = last - first;
+  const int      order = parameters_.particles.integratorOrder;
+  const RealType cfl   = parameters_.particles.cfl;
+
+  // Particles of the batch, and the positions, cells and velocities of an intermediate stage of the integrator
+  std::array<const RealType*, Dim> positions;
+  std::array<RealType*, Dim>       velocities;
+  std::array<const RealType*, Dim> stagePositions;
+  std::array<const int*, Dim>      stageIndices;
+  std::array<RealType*, Dim>       stageVelocities;
+  std::array<RealType*, Dim>       increments;
+  RealType                         stagePositionBuffer[Dim][PARTICLE_BATCH_SIZE];
+  int                              stageIndexBuffer[Dim][PARTICLE_BATCH_SIZE];
+  RealType                         stageVelocityBuffer[Dim][PARTICLE_BATCH_SIZE];
+  RealType                         incrementBuffer[Dim][PARTICLE_BATCH_SIZE];
+  for (int d = 0; d < Dim; d++) {
+    positions[d]       = particles_.getPositions(d) + first;
+    velocities[d]      = particles_.getVelocities(d) + first;
+    stagePositions[d]  = stagePositionBuffer[d];
+    stageIndices[d]    = stageIndexBuffer[d];
+    stageVelocities[d] = stageVelocityBuffer[d];
+    increments[d]      = incrementBuffer[d];
+  }
+
+  // The interpolation needs a cell with a lower neighbour inside the local field
+  const auto locate = [&](int d, RealType coordinate) {
+    return std::clamp(parameters_.meshsize->locateCell(d, coordinate), 1, static_cast<int>(cellStarts_[d].size()) - 1);
+  };
+
+  // Velocities at the particles at time theta of the time step
+  const auto sampleParticles = [&](RealType theta) {
+    for (int d = 0; d < Dim; d++) {
+      const int* const indices = particles_.getIndices(d) + first;
+      for (int p = 0; p < count; p++) {
+        stageIndexBuffer[d][p] = std::clamp(indices[p], 1, static_cast<int>(cellStarts_[d].size()) - 1);
+      }
+    }
+    interpolateVelocities(count, positions, stageIndices, theta, velocities);
+  };
+
+  // Velocities at the particles moved by fraction of the sub-step h with the given slopes, at time theta
+  const auto sampleStage = [&](const std::array<RealType*, Dim>& slopes, RealType h, RealType theta) {
+    for (int d = 0; d < Dim; d++) {
+      for (int p = 0; p < count; p++) {
+        stagePositionBuffer[d][p] = positions[d][p] + h * slopes[d][p];
+        stageIndexBuffer[d][p]    = locate(d, stagePositionBuffer[d][p]);
+      }
+    }
+    interpolateVelocities(count, stagePositions, stageIndices, theta, stageVelocities);
+  };
+
+  // Adds the stage velocities with the given weight to the increments
+  const auto accumulate = [&](RealType weight) {
+    for (int d = 0; d < Dim; d++) {
+      for (int p = 0; p < count; p++) {
+        incrementBuffer[d][p] += weight * stageVelocityBuffer[d][p];
+      }
+    }
+  };
+
+  sampleParticles(0.0);
+
+  // Sub-steps such that no particle of the batch moves further than cfl cells in one of them
+  int subSteps = 1;
+  if (cfl > 0.0) {
+    RealType cells = 0.0;
+    for (int d = 0; d < Dim; d++) {
+      for (int p = 0; p < count; p++) {
+        cells = std::max(cells, std::abs(velocities[d][p]) * dt * inverseSpacings_[d][stageIndexBuffer[d][p]]);
       }
-      index[1] = j;
-      for (int pz = 0; pz < particleCount; pz++) {
-        z += spacingZ;
-        while (parameters_.meshsize->getPosZ(0, 0, k) + parameters_.meshsize->getDz(0, 0, k) <= z) {
-          k++;
+    }
+    subSteps = std::max(1, static_cast<int>(std::ceil(cells / cfl)));
+  }
+  const RealType h     = dt / subSteps;
+  const RealType share = 1.0 / subSteps;
+
+  for (int s = 0; s < subSteps; s++) {
+    const RealType theta = s * share;
+    if (s > 0) {
+      sampleParticles(theta);
+    }
+
+    // Runge-Kutta stages, of which the weighted mean replaces the velocity of the particles for the sub-step
+    if (order == 2) {
+      sampleStage(velocities, h, theta + share);
+      for (int d = 0; d < Dim; d++) {
+        for (int p = 0; p < count; p++) {
+          velocities[d][p] = 0.5 * (velocities[d][p] + stageVelocityBuffer[d][p]);
         }
-        index[2] = k;
-        if (x > parameters_.meshsize->getPosX(2, 0, 0)) {
-          if (index[0] >= 2 && index[0] < flowField_.getCellsX() - 1 
-              && index[1] >= 2 && index[1] < flowField_.getCellsY() - 1 
-              && index[2] >= 2 && index[2] < flowField_.getCellsZ() - 1){
-            particles_.push_front(Particle(x, y, index, flowField_, parameters_));
-          }
+      }
+    } else if (order == 4) {
+      for (int d = 0; d < Dim; d++) {
+        std::copy(velocities[d], velocities[d] + count, incrementBuffer[d]);
+      }
+      sampleStage(velocities, 0.5 * h, theta + 0.5 * share);
+      accumulate(2.0);
+      sampleStage(stageVelocities, 0.5 * h, theta + 0.5 * share);
+      accumulate(2.0);
+      sampleStage(stageVelocities, h, theta + share);
+      accumulate(1.0);
+      for (int d = 0; d < Dim; d++) {
+        for (int p = 0; p < count; p++) {
+          velocities[d][p] = incrementBuffer[d][p] / 6.0;
         }
       }
     }
+
+    for (int p = first; p < last; p++) {
+      updateParticle(p, h, hits);
+    }
+  }
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::retainVelocity() {
+  VectorField&          velocity = flowField_.getVelocity();
+  const RealType* const field    = velocity.getData();
+  previousVelocity_.assign(field, field + velocity.getSize());
+}
+
+template <int Dim>
+RealType ParticleSimulation<Dim>::getCellStart(int d, int index) const {
+  switch (d) {
+  case 0:
+    return parameters_.meshsize->getPosX(index, 0, 0);
+  case 1:
+    return parameters_.meshsize->getPosY(0, index, 0);
+  default:
+    return parameters_.meshsize->getPosZ(0, 0, index);
   }
 }
 
-void ParticleSimulation::solveTimestep() {
+template <int Dim>
+void ParticleSimulation<Dim>::updateParticle(int p, RealType dt, Hits& hits) {
+  std::array<int, Dim> previousIndex;
+
+  // Look the cells up directly, independent of how many cells the particles crossed
+  for (int d = 0; d < Dim; d++) {
+    RealType& position = particles_.getPositions(d)[p];
+    int&      index    = particles_.getIndices(d)[p];
 
-  for (auto& particle : particles_) {
-    particle.update(parameters_.timestep.dt);
+    previousIndex[d] = index;
+    position += dt * particles_.getVelocities(d)[p];
+    index = parameters_.meshsize->locateCell(d, position);
   }
 
-  communicateParticles();
+  applyBoundaryCondition(p, previousIndex, hits);
 }
 
-void ParticleSimulation::plot(int timeSteps, RealType time) {
-  const int dim = parameters_.geometry.dim;
+template <int Dim>
+int ParticleSimulation<Dim>::getFlags(const std::array<int, Dim>& index) const {
+  const int cells[3] = {flowField_.getCellsX(), flowField_.getCellsY(), flowField_.getCellsZ()};
+  for (int d = 0; d < Dim; d++) {
+    if (index[d] < 0 || index[d] >= cells[d]) {
+      return 0;
+    }
+  }
+  if constexpr (Dim == 2) {
+    return flowField_.getFlags().getValue(index[0], index[1]);
+  } else {
+    return flowField_.getFlags().getValue(index[0], index[1], index[2]);
+  }
+}
 
-  // open file
-  std::string       prefix       = parameters_.vtk.prefix; // read the prefix
-  std::string       outputFolder = "Output/" + prefix;
-  std::stringstream namestream;
-  std::string       name;
-  std::string       grid;
-  char              buffer[256];
+template <int Dim>
+void ParticleSimulation<Dim>::applyBoundaryCondition(int p, const std::array<int, Dim>& previousIndex, Hits& hits) {
+  std::array<int, Dim> index;
+
+  // Walls of the domain
+  for (int d = 0; d < Dim; d++) {
+    RealType& position = particles_.getPositions(d)[p];
+    RealType& velocity = particles_.getVelocities(d)[p];
+    int&      cell     = particles_.getIndices(d)[p];
+
+    if (walls_[d][0] && position < 0) {
+      wallCorrect(position, 0.0, velocity);
+      cell = parameters_.meshsize->locateCell(d, position);
+      hits[2 * d]++;
+    } else if (walls_[d][1] && position > lengths_[d]) {
+      wallCorrect(position, lengths_[d], velocity);
+      cell = parameters_.meshsize->locateCell(d, position);
+      hits[2 * d + 1]++;
+    }
+    index[d] = cell;
+  }
 
-  namestream.precision(4);
-  namestream
-    << "Output"
-    << "/" << prefix << "/" << prefix << "particles." << parameters_.parallel.rank << "." << timeSteps << ".vtk";
-  name = namestream.str();
-  std::ofstream ofile;
-  ofile.open(name.c_str()); // open the file
-  namestream.str("");
+  // Obstacles inside the domain
+  if ((getFlags(index) & OBSTACLE_SELF) == 0) {
+    return;
+  }
 
-  // write header
-  ofile << "# vtk DataFile Version 2.0" << std::endl << "NS-EOF" << std::endl << "ASCII" << std::endl << std::endl;
+  hits[ParticleStatistics::OBSTACLES]++;
 
-  grid.reserve((ofile.precision() + 6) * particles_.size() * 3);
+  static constexpr int lowerObstacles[3] = {OBSTACLE_LEFT, OBSTACLE_BOTTOM, OBSTACLE_FRONT};
+  static constexpr int upperObstacles[3] = {OBSTACLE_RIGHT, OBSTACLE_TOP, OBSTACLE_BACK};
+  const int            previousFlags     = getFlags(previousIndex);
 
-  sprintf(buffer, "DATASET POLYDATA\nPOINTS %d float\n", particles_.size());
-  grid.append(buffer);
+  // A particle which crossed an edge or a corner of the obstacle did not pass a face marked in the previous cell, so
+  // it is reflected along all axes it moved along
+  bool faceCrossed = false;
+  for (int d = 0; d < Dim; d++) {
+    faceCrossed |= (index[d] < previousIndex[d] && (previousFlags & lowerObstacles[d]))
+                   || (index[d] > previousIndex[d] && (previousFlags & upperObstacles[d]));
+  }
 
-  // loop over particles
-  if (dim == 3) {
-    for (auto& particle : particles_) {
-      sprintf(buffer, "%f %f %f\n", particle.getX(), particle.getY(), particle.getZ());
-      grid.append(buffer);
-    }
-  } else {
-    for (auto particle : particles_) {
-      sprintf(buffer, "%f %f 0.0\n", particle.getX(), particle.getY());
-      grid.append(buffer);
+  for (int d = 0; d < Dim; d++) {
+    const bool lower = index[d] < previousIndex[d] && (!faceCrossed || (previousFlags & lowerObstacles[d]));
+    const bool upper = index[d] > previousIndex[d] && (!faceCrossed || (previousFlags & upperObstacles[d]));
+    if (lower || upper) {
+      RealType& position = particles_.getPositions(d)[p];
+      RealType& velocity = particles_.getVelocities(d)[p];
+      wallCorrect(position, cellStarts_[d][lower ? previousIndex[d] : previousIndex[d] + 1], velocity);
+      particles_.getIndices(d)[p] = parameters_.meshsize->locateCell(d, position);
     }
   }
+}
 
-  // close file
-  grid.append("\n");
-  ofile << grid;
-  ofile.close();
+template <int Dim>
+inline void ParticleSimulation<Dim>::wallCorrect(RealType& x, RealType limitX, RealType& velocity) {
+  x        = 2 * limitX - x;
+  velocity = -velocity;
 }
 
-std::vector<RealType> ParticleSimulation::collectLeftBoundaryParticles() {
-  const int             dim = parameters_.geometry.dim;
-  std::vector<RealType> sendBuffer;
+template <int Dim>
+void ParticleSimulation<Dim>::computeSeeds() {
+  // Number of particles in each direction (2D: y - 3D: y & z)
+  const int particleCount = parameters_.particles.particleCount;
 
-  for (auto& particle : particles_) {
-    if (particle.getI() < 2) { // left ghost cell territory
-      if (dim == 2) {
-        sendBuffer.push_back(particle.getX());
-        sendBuffer.push_back(particle.getY());
-        sendBuffer.push_back(particle.getU());
-        sendBuffer.push_back(particle.getV());
-        sendBuffer.push_back(static_cast<RealType>(particle.getI()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getJ()));
-      } else {
-        sendBuffer.push_back(particle.getX());
-        sendBuffer.push_back(particle.getY());
-        sendBuffer.push_back(particle.getZ());
-        sendBuffer.push_back(particle.getU());
-        sendBuffer.push_back(particle.getV());
-        sendBuffer.push_back(particle.getW());
-        sendBuffer.push_back(static_cast<RealType>(particle.getI()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getJ()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getK()));
+  const RealType lengthY = (parameters_.bfStep.yRatio <= 0.0)
+                             ? parameters_.geometry.lengthY
+                             : parameters_.geometry.lengthY * (1 - parameters_.bfStep.yRatio);
+  const RealType lengthZ = parameters_.geometry.lengthZ;
+
+  // Assuming uniform spacing between particles
+  const RealType spacingY = lengthY / (particleCount + 1);
+  const RealType spacingZ = lengthZ / (particleCount + 1);
+  const RealType startY   = (parameters_.bfStep.yRatio >= 0) ? (parameters_.bfStep.yRatio * parameters_.geometry.lengthY)
+                                                             : 0;
+
+  // The particles are seeded at the inlet of a channel and through the middle of a cavity
+  std::array<RealType, Dim> position;
+  std::array<int, Dim>      index;
+  position[0] = (parameters_.simulation.scenario == "cavity")
+                  ? (parameters_.geometry.lengthX + parameters_.meshsize->getDx(2, 1)) / 2.0
+                  : parameters_.meshsize->getDx(2, 0) / 2;
+  index[0]    = parameters_.meshsize->locateCell(0, position[0]);
+
+  // Uniform distribution of the particles on a line in y-direction (2D) or in the yz-plane (3D), which avoids having
+  // particles at exactly the walls. Only the seeds in the subdomain are kept.
+  // The number of a seed among all seeds of an injection identifies it, also when other ranks own the other seeds.
+  seeds_.clear();
+  for (int py = 1; py <= particleCount; py++) {
+    position[1] = startY + py * spacingY;
+    index[1]    = parameters_.meshsize->locateCell(1, position[1]);
+    for (int pz = 1; pz <= ((Dim == 3) ? particleCount : 1); pz++) {
+      if constexpr (Dim == 3) {
+        position[2] = pz * spacingZ;
+        index[2]    = parameters_.meshsize->locateCell(2, position[2]);
+      }
+      if (isInSubdomain(index)) {
+        const std::int64_t seed = static_cast<std::int64_t>(py - 1) * ((Dim == 3) ? particleCount : 1) + pz - 1;
+        seeds_.add(position, index, 0, seed);
       }
     }
   }
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::initializeParticles() {
+  const int injection = injections_++;
+  injectionTimes_.push_back(time_);
+
+  // Keep the subdomain within its particle budget
+  const int maxParticles = parameters_.particles.maxParticles;
+  if (maxParticles > 0 && particles_.size() + seeds_.size() > maxParticles) {
+    if (!parameters_.particles.dropOldest) {
+      spdlog::debug("Processor {} skips the injection of {} particles", parameters_.parallel.rank, seeds_.size());
+      return;
+    }
+    removeOldestParticles(std::min(particles_.size() + seeds_.size() - maxParticles, particles_.size()));
+  }
 
-  particles_.remove_if([this](Particle& particle) { return particle.getI() < 2; });
+  // Particles of later injections get identifiers beyond the ones of all seeds of the earlier injections
+  std::int64_t seedsPerInjection = parameters_.particles.particleCount;
+  if constexpr (Dim == 3) {
+    seedsPerInjection *= parameters_.particles.particleCount;
+  }
+  particles_.append(seeds_, injection, injection * seedsPerInjection);
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::removeOldestParticles(int count) {
+  const int* const injections = particles_.getInjections();
+  std::vector<int> oldest(particles_.size());
+  std::iota(oldest.begin(), oldest.end(), 0);
+  std::nth_element(oldest.begin(), oldest.begin() + count, oldest.end(), [&](int p, int q) {
+    return injections[p] < injections[q];
+  });
+  oldest.resize(count);
+
+  // Removing a particle moves the last one into its slot, hence the particles are removed from the back
+  std::sort(oldest.begin(), oldest.end(), std::greater<int>());
+  for (const int p : oldest) {
+    particles_.remove(p);
+  }
+}
 
-  if (sendBuffer.size() == 0)
-    sendBuffer.push_back(0.0);
-  return sendBuffer;
+template <int Dim>
+void ParticleSimulation<Dim>::solveTimestep() {
+  advectParticles(parameters_.timestep.dt);
+  communicateParticles();
 }
 
-std::vector<RealType> ParticleSimulation::collectRightBoundaryParticles() {
-  const int             dim = parameters_.geometry.dim;
-  std::vector<RealType> sendBuffer;
+template <int Dim>
+void ParticleSimulation<Dim>::advectParticles(RealType dt) {
+  const int numberOfParticles = particles_.size();
 
-  for (auto& particle : particles_) {
-    if (particle.getI() >= parameters_.parallel.localSize[0] + 2) { // right ghost cell territory
-      if (dim == 2) {
-        sendBuffer.push_back(particle.getX());
-        sendBuffer.push_back(particle.getY());
-        sendBuffer.push_back(particle.getU());
-        sendBuffer.push_back(particle.getV());
-        sendBuffer.push_back(static_cast<RealType>(particle.getI()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getJ()));
-        // throw std::runtime_error("EH");
-      } else {
-        sendBuffer.push_back(particle.getX());
-        sendBuffer.push_back(particle.getY());
-        sendBuffer.push_back(particle.getZ());
-        sendBuffer.push_back(particle.getU());
-        sendBuffer.push_back(particle.getV());
-        sendBuffer.push_back(particle.getW());
-        sendBuffer.push_back(static_cast<RealType>(particle.getI()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getJ()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getK()));
+  // Particles which are close in memory then read the same velocities of the field
+  if (parameters_.particles.sortInterval > 0 && ++stepsSinceSort_ >= parameters_.particles.sortInterval) {
+    if constexpr (Dim == 2) {
+      particles_.sortByCell({flowField_.getCellsX(), flowField_.getCellsY()});
+    } else {
+      particles_.sortByCell({flowField_.getCellsX(), flowField_.getCellsY(), flowField_.getCellsZ()});
+    }
+    stepsSinceSort_ = 0;
+  }
+
+#ifdef _OPENMP
+  threadMigrants_.resize(omp_get_max_threads());
+#else
+  threadMigrants_.resize(1);
+#endif
+  for (auto& threadMigrants : threadMigrants_) {
+    threadMigrants.particles.clear();
+    threadMigrants.hits.fill(0);
+  }
+
+  // Every thread advects a contiguous chunk of the particles and collects the ones leaving the subdomain on its own
+#pragma omp parallel
+  {
+#ifdef _OPENMP
+    ThreadMigrants& threadMigrants = threadMigrants_[omp_get_thread_num()];
+#else
+    ThreadMigrants& threadMigrants = threadMigrants_[0];
+#endif
+
+    // Velocities are interpolated for a whole batch before the particles of the batch are moved one by one
+#pragma omp for schedule(static)
+    for (int first = 0; first < numberOfParticles; first += PARTICLE_BATCH_SIZE) {
+      const int last = std::min(first + PARTICLE_BATCH_SIZE, numberOfParticles);
+      integrateParticles(first, last, dt, threadMigrants.hits);
+      for (int p = first; p < last; p++) {
+        if (!isInSubdomain(p)) {
+          threadMigrants.particles.push_back(p);
+        }
       }
     }
   }
 
-  particles_.remove_if([this](Particle& particle) { return particle.getI() >= parameters_.parallel.localSize[0] + 2; });
+  migrants_.clear();
+  Hits hits{};
+  for (const auto& threadMigrants : threadMigrants_) {
+    migrants_.insert(migrants_.end(), threadMigrants.particles.begin(), threadMigrants.particles.end());
+    for (int region = 0; region < ParticleStatistics::NUMBER_OF_REGIONS; region++) {
+      hits[region] += threadMigrants.hits[region];
+    }
+  }
+  time_ += dt;
+
+  // The statistics see the particles which left the subdomain as well, their new owners only see them next time
+  if (!statistics_.empty()) {
+    speeds_.resize(numberOfParticles);
+    residenceTimes_.resize(numberOfParticles);
+    for (int p = 0; p < numberOfParticles; p++) {
+      RealType speed = 0.0;
+      for (int d = 0; d < Dim; d++) {
+        speed += particles_.getVelocities(d)[p] * particles_.getVelocities(d)[p];
+      }
+      speeds_[p]         = std::sqrt(speed);
+      residenceTimes_[p] = time_ - injectionTimes_[particles_.getInjections()[p]];
+    }
+    for (auto& statistic : statistics_) {
+      statistic->sample({speeds_, residenceTimes_, hits});
+    }
+  }
 
-  if (sendBuffer.size() == 0)
-    sendBuffer.push_back(0.0);
-  return sendBuffer;
+  // The current field is the previous one of the next time step
+  if (retainVelocity_) {
+    retainVelocity();
+  }
 }
 
-std::vector<RealType> ParticleSimulation::collectBottomBoundaryParticles() {
-  const int             dim = parameters_.geometry.dim;
-  std::vector<RealType> sendBuffer;
+template <int Dim>
+const ParticleContainer<Dim>& ParticleSimulation<Dim>::getParticles() const { return particles_; }
 
-  for (auto& particle : particles_) {
-    if (particle.getJ() < 2) { // bottom ghost cell territory
-      if (dim == 2) {
-        sendBuffer.push_back(particle.getX());
-        sendBuffer.push_back(particle.getY());
-        sendBuffer.push_back(particle.getU());
-        sendBuffer.push_back(particle.getV());
-        sendBuffer.push_back(static_cast<RealType>(particle.getI()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getJ()));
-      } else {
-        sendBuffer.push_back(particle.getX());
-        sendBuffer.push_back(particle.getY());
-        sendBuffer.push_back(particle.getZ());
-        sendBuffer.push_back(particle.getU());
-        sendBuffer.push_back(particle.getV());
-        sendBuffer.push_back(particle.getW());
-        sendBuffer.push_back(static_cast<RealType>(particle.getI()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getJ()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getK()));
-      }
+template <int Dim>
+const ParticleStatistics::Statistics& ParticleSimulation<Dim>::getStatistics() const { return statistics_; }
+
+template <int Dim>
+int ParticleSimulation<Dim>::getNumberOfParticles() const { return particles_.size(); }
+
+template <int Dim>
+void ParticleSimulation<Dim>::writeStatistics(int timeSteps, RealType time) {
+  ParticleStatistics::reduce(statistics_, parameters_.vtk.prefix, parameters_.parallel.rank, timeSteps, time);
+}
+
+// Types and byte order of the binary particle output
+static constexpr const char* VTK_REAL_TYPE  = (sizeof(RealType) == 4) ? "Float32" : "Float64";
+static constexpr const char* VTK_BYTE_ORDER = (std::endian::native == std::endian::little) ? "LittleEndian"
+                                                                                           : "BigEndian";
+
+// Writes an array of the appended data of a VTK XML file, preceded by its size in bytes
+template <class T>
+static void writeAppendedArray(std::ostream& file, const T* values, std::size_t count) {
+  const std::uint64_t bytes = count * sizeof(T);
+  file.write(reinterpret_cast<const char*>(&bytes), sizeof(bytes));
+  file.write(reinterpret_cast<const char*>(values), bytes);
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::plot(int timeSteps, RealType time) {
+  const std::string& prefix            = parameters_.vtk.prefix;
+  const std::string  outputFolder      = "Output/" + prefix + "/";
+  const int          numberOfParticles = particles_.size();
+
+  // Points and velocities have three components also in 2D
+  plotPositions_.assign(3 * numberOfParticles, 0.0);
+  plotVelocities_.assign(3 * numberOfParticles, 0.0);
+  for (int d = 0; d < Dim; d++) {
+    const RealType* const positions  = particles_.getPositions(d);
+    const RealType* const velocities = particles_.getVelocities(d);
+    for (int p = 0; p < numberOfParticles; p++) {
+      plotPositions_[3 * p + d]  = positions[p];
+      plotVelocities_[3 * p + d] = velocities[p];
     }
   }
 
-  particles_.remove_if([this](Particle& particle) { return particle.getJ() < 2; });
+  // The arrays are appended in the order velocity, id, points, each behind its size
+  const std::uint64_t vectorBytes = sizeof(std::uint64_t) + 3 * numberOfParticles * sizeof(RealType);
+  const std::uint64_t idBytes     = sizeof(std::uint64_t) + numberOfParticles * sizeof(std::int64_t);
+
+  const std::string name = prefix + "particles." + std::to_string(parameters_.parallel.rank) + "."
+                           + std::to_string(timeSteps) + ".vtp";
+  std::ofstream ofile(outputFolder + name, std::ios::binary);
+  ofile.precision(std::numeric_limits<RealType>::max_digits10);
+  ofile << "<?xml version=\"1.0\"?>" << std::endl
+        << "<VTKFile type=\"PolyData\" version=\"1.0\" byte_order=\"" << VTK_BYTE_ORDER
+        << "\" header_type=\"UInt64\">" << std::endl
+        << "  <PolyData>" << std::endl
+        << "    <FieldData>" << std::endl
+        << "      <DataArray type=\"Float64\" Name=\"TimeValue\" NumberOfTuples=\"1\" format=\"ascii\">" << time
+        << "</DataArray>" << std::endl
+        << "    </FieldData>" << std::endl
+        << "    <Piece NumberOfPoints=\"" << numberOfParticles
+        << "\" NumberOfVerts=\"0\" NumberOfLines=\"0\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">" << std::endl
+        << "      <PointData Vectors=\"velocity\" Scalars=\"id\">" << std::endl
+        << "        <DataArray type=\"" << VTK_REAL_TYPE
+        << "\" Name=\"velocity\" NumberOfComponents=\"3\" format=\"appended\" offset=\"0\"/>" << std::endl
+        << "        <DataArray type=\"Int64\" Name=\"id\" format=\"appended\" offset=\"" << vectorBytes << "\"/>"
+        << std::endl
+        << "      </PointData>" << std::endl
+        << "      <Points>" << std::endl
+        << "        <DataArray type=\"" << VTK_REAL_TYPE << "\" NumberOfComponents=\"3\" format=\"appended\" offset=\""
+        << vectorBytes + idBytes << "\"/>" << std::endl
+        << "      </Points>" << std::endl
+        << "    </Piece>" << std::endl
+        << "  </PolyData>" << std::endl
+        << "  <AppendedData encoding=\"raw\">" << std::endl
+        << "_";
+  writeAppendedArray(ofile, plotVelocities_.data(), plotVelocities_.size());
+  writeAppendedArray(ofile, particles_.getIds(), numberOfParticles);
+  writeAppendedArray(ofile, plotPositions_.data(), plotPositions_.size());
+  ofile << std::endl << "  </AppendedData>" << std::endl << "</VTKFile>" << std::endl;
+  ofile.close();
+
+  // Rank 0 indexes the pieces of all ranks
+  if (parameters_.parallel.rank == 0) {
+    int nproc = parameters_.parallel.numProcessors[0] * parameters_.parallel.numProcessors[1];
+    if constexpr (Dim == 3) {
+      nproc *= parameters_.parallel.numProcessors[2];
+    }
 
-  if (sendBuffer.size() == 0)
-    sendBuffer.push_back(0.0);
-  return sendBuffer;
+    std::ofstream index(outputFolder + prefix + "particles." + std::to_string(timeSteps) + ".pvtp");
+    index << "<?xml version=\"1.0\"?>" << std::endl
+          << "<VTKFile type=\"PPolyData\" version=\"1.0\" byte_order=\"" << VTK_BYTE_ORDER
+          << "\" header_type=\"UInt64\">" << std::endl
+          << "  <PPolyData GhostLevel=\"0\">" << std::endl
+          << "    <PPointData Vectors=\"velocity\" Scalars=\"id\">" << std::endl
+          << "      <PDataArray type=\"" << VTK_REAL_TYPE << "\" Name=\"velocity\" NumberOfComponents=\"3\"/>"
+          << std::endl
+          << "      <PDataArray type=\"Int64\" Name=\"id\"/>" << std::endl
+          << "    </PPointData>" << std::endl
+          << "    <PPoints>" << std::endl
+          << "      <PDataArray type=\"" << VTK_REAL_TYPE << "\" NumberOfComponents=\"3\"/>" << std::endl
+          << "    </PPoints>" << std::endl;
+    for (int r = 0; r < nproc; r++) {
+      index << "    <Piece Source=\"" << prefix << "particles." << r << "." << timeSteps << ".vtp\"/>" << std::endl;
+    }
+    index << "  </PPolyData>" << std::endl << "</VTKFile>" << std::endl;
+  }
 }
 
-std::vector<RealType> ParticleSimulation::collectTopBoundaryParticles() {
-  const int             dim = parameters_.geometry.dim;
-  std::vector<RealType> sendBuffer;
+template <int Dim>
+void ParticleSimulation<Dim>::recordTrajectories(int timeSteps, RealType time) {
+  const int stride = parameters_.particles.trajectoryStride;
+  if (stride <= 0 || timeSteps % stride != 0) {
+    return;
+  }
 
-  for (auto& particle : particles_) {
-    if (particle.getJ() >= parameters_.parallel.localSize[1] + 2) { // top ghost cell territory
-      if (dim == 2) {
-        sendBuffer.push_back(particle.getX());
-        sendBuffer.push_back(particle.getY());
-        sendBuffer.push_back(particle.getU());
-        sendBuffer.push_back(particle.getV());
-        sendBuffer.push_back(static_cast<RealType>(particle.getI()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getJ()));
-      } else {
-        sendBuffer.push_back(particle.getX());
-        sendBuffer.push_back(particle.getY());
-        sendBuffer.push_back(particle.getZ());
-        sendBuffer.push_back(particle.getU());
-        sendBuffer.push_back(particle.getV());
-        sendBuffer.push_back(particle.getW());
-        sendBuffer.push_back(static_cast<RealType>(particle.getI()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getJ()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getK()));
-      }
+  if (!trajectoryFile_.is_open()) {
+    // A restarted run continues the log of the run it restarts from, which readCheckpoint() cut off at the checkpoint
+    const std::string name   = ParticleTrajectory::getFileName(parameters_.vtk.prefix, parameters_.parallel.rank);
+    const bool        append = !parameters_.particles.restart.empty() && std::filesystem::exists(name)
+                        && std::filesystem::file_size(name) >= sizeof(ParticleTrajectory::Header);
+    trajectoryFile_.open(name, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    if (!trajectoryFile_) {
+      spdlog::error("Cannot open the particle trajectory log {}", name);
+      throw std::runtime_error("Error while opening the particle trajectory log");
+    }
+    if (!append) {
+      ParticleTrajectory::writeHeader(trajectoryFile_, Dim);
     }
   }
 
-  particles_.remove_if([this](Particle& particle) { return particle.getJ() >= parameters_.parallel.localSize[1] + 2; });
+  // The records of all particles are written in one go
+  const int numberOfParticles = particles_.size();
+  trajectoryRecords_.resize(numberOfParticles);
+  for (int p = 0; p < numberOfParticles; p++) {
+    ParticleTrajectory::Record& record = trajectoryRecords_[p];
+    record.id                          = particles_.getIds()[p];
+    record.time                        = time;
+    for (int d = 0; d < 3; d++) {
+      record.position[d] = (d < Dim) ? particles_.getPositions(d)[p] : 0.0;
+      record.velocity[d] = (d < Dim) ? particles_.getVelocities(d)[p] : 0.0;
+    }
+  }
+  trajectoryFile_.write(
+    reinterpret_cast<const char*>(trajectoryRecords_.data()), numberOfParticles * sizeof(ParticleTrajectory::Record)
+  );
+  trajectoryFile_.flush();
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::depositParticles() {
+  if (parameters_.particles.deposit.empty()) {
+    return;
+  }
+
+  ScalarField&    concentration = flowField_.getConcentration();
+  RealType* const field         = concentration.getData();
+  const int       strides[3]    = {1, concentration.getPitch(), concentration.getPitch() * concentration.getNy()};
+  std::fill(field, field + concentration.getSize(), 0.0);
+
+  const int corners = cloudInCell_ ? (1 << Dim) : 1;
+  for (int p = 0; p < particles_.size(); p++) {
+    // Every particle adds a unit to the cell it is in, or to the 2^Dim cells whose centres surround it in proportion
+    // to its distance from the centres
+    int      lower[Dim];
+    RealType weights[Dim][2];
+    for (int d = 0; d < Dim; d++) {
+      const int index = particles_.getIndices(d)[p];
+      lower[d]        = index;
+      weights[d][0]   = 1.0;
+      weights[d][1]   = 0.0;
+      if (cloudInCell_) {
+        const RealType coordinate = particles_.getPositions(d)[p];
+        const auto     centre     = [&](int c) { return cellStarts_[d][c] + 0.5 / inverseSpacings_[d][c]; };
+        lower[d]                  = (coordinate < centre(index)) ? index - 1 : index;
+        weights[d][1]             = (coordinate - centre(lower[d])) / (centre(lower[d] + 1) - centre(lower[d]));
+        weights[d][0]             = 1.0 - weights[d][1];
+      }
+    }
+
+    for (int corner = 0; corner < corners; corner++) {
+      int      cell   = 0;
+      RealType amount = 1.0;
+      for (int d = 0; d < Dim; d++) {
+        const int index = lower[d] + ((corner >> d) & 1);
+        cell += index * strides[d];
+        amount *= weights[d][(corner >> d) & 1] * inverseSpacings_[d][index];
+      }
+      field[cell] += amount;
+    }
+  }
 
-  if (sendBuffer.size() == 0)
-    sendBuffer.push_back(0.0);
-  return sendBuffer;
+  foldGhostLayers();
 }
 
-std::vector<RealType> ParticleSimulation::collectFrontBoundaryParticles() {
-  const int             dim = parameters_.geometry.dim;
-  std::vector<RealType> sendBuffer;
+template <int Dim>
+void ParticleSimulation<Dim>::foldGhostLayers() {
+  ScalarField&    concentration = flowField_.getConcentration();
+  RealType* const field         = concentration.getData();
+  const int       cells[3]      = {concentration.getNx(), concentration.getNy(), concentration.getNz()};
+  const int       strides[3]    = {1, concentration.getPitch(), concentration.getPitch() * concentration.getNy()};
+
+  const ParallelParameters& parallel           = parameters_.parallel;
+  const int                 lowerNeighbours[3] = {parallel.leftNb, parallel.bottomNb, parallel.frontNb};
+  const int                 upperNeighbours[3] = {parallel.rightNb, parallel.topNb, parallel.backNb};
+
+  std::vector<int>      offsets;
+  std::vector<RealType> lowerSend, upperSend, lowerRecv, upperRecv;
+  for (int d = 0; d < Dim; d++) {
+    // A layer spans all cells of the other axes, ghost cells included, so that the deposit in the edges and corners
+    // of the ghost layers is passed on along the next axes
+    const int a         = (d == 0) ? 1 : 0;
+    const int b         = (d == 2) ? 1 : 2;
+    const int layerSize = cells[a] * ((Dim == 3) ? cells[b] : 1);
+    offsets.resize(layerSize);
+    for (int n = 0; n < layerSize; n++) {
+      offsets[n] = (n % cells[a]) * strides[a] + (n / cells[a]) * strides[b];
+    }
+    const int lowerGhost = strides[d];
+    const int lowerInner = 2 * strides[d];
+    const int upperInner = (cells[d] - 2) * strides[d];
+    const int upperGhost = (cells[d] - 1) * strides[d];
+
+    lowerSend.resize(layerSize);
+    upperSend.resize(layerSize);
+    lowerRecv.assign(layerSize, 0.0);
+    upperRecv.assign(layerSize, 0.0);
+    for (int n = 0; n < layerSize; n++) {
+      lowerSend[n] = field[lowerGhost + offsets[n]];
+      upperSend[n] = field[upperGhost + offsets[n]];
+    }
+
+    // The ghost layers of a subdomain are inner layers of its neighbours, which add them to their own deposit. A
+    // subdomain which spans the whole domain along the axis has no one to exchange them with.
+    if (lowerNeighbours[d] != MPI_PROC_NULL || upperNeighbours[d] != MPI_PROC_NULL) {
+      MPI_Sendrecv(
+        lowerSend.data(),
+        layerSize,
+        MY_MPI_FLOAT,
+        lowerNeighbours[d],
+        0,
+        upperRecv.data(),
+        layerSize,
+        MY_MPI_FLOAT,
+        upperNeighbours[d],
+        0,
+        PETSC_COMM_WORLD,
+        MPI_STATUS_IGNORE
+      );
+      MPI_Sendrecv(
+        upperSend.data(),
+        layerSize,
+        MY_MPI_FLOAT,
+        upperNeighbours[d],
+        1,
+        lowerRecv.data(),
+        layerSize,
+        MY_MPI_FLOAT,
+        lowerNeighbours[d],
+        1,
+        PETSC_COMM_WORLD,
+        MPI_STATUS_IGNORE
+      );
+    }
 
-  for (auto& particle : particles_) {
-    if (particle.getK() < 2) { // front ghost cell territory
-      if (dim == 2) {
-        sendBuffer.push_back(particle.getX());
-        sendBuffer.push_back(particle.getY());
-        sendBuffer.push_back(particle.getU());
-        sendBuffer.push_back(particle.getV());
-        sendBuffer.push_back(static_cast<RealType>(particle.getI()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getJ()));
-      } else {
-        sendBuffer.push_back(particle.getX());
-        sendBuffer.push_back(particle.getY());
-        sendBuffer.push_back(particle.getZ());
-        sendBuffer.push_back(particle.getU());
-        sendBuffer.push_back(particle.getV());
-        sendBuffer.push_back(particle.getW());
-        sendBuffer.push_back(static_cast<RealType>(particle.getI()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getJ()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getK()));
+    // At the domain boundaries, the deposit in a ghost layer is folded back into the inner layer next to it. The
+    // values are densities, hence they are scaled by the ratio of the mesh sizes of the two layers.
+    if (lowerNeighbours[d] == MPI_PROC_NULL) {
+      const RealType ratio = inverseSpacings_[d][2] / inverseSpacings_[d][1];
+      for (int n = 0; n < layerSize; n++) {
+        lowerRecv[n] = lowerSend[n] * ratio;
       }
     }
+    if (upperNeighbours[d] == MPI_PROC_NULL) {
+      const RealType ratio = inverseSpacings_[d][cells[d] - 2] / inverseSpacings_[d][cells[d] - 1];
+      for (int n = 0; n < layerSize; n++) {
+        upperRecv[n] = upperSend[n] * ratio;
+      }
+    }
+
+    // The ghost layers are cleared, so that their deposit is not passed on again along the next axes
+    for (int n = 0; n < layerSize; n++) {
+      field[lowerInner + offsets[n]] += lowerRecv[n];
+      field[upperInner + offsets[n]] += upperRecv[n];
+      field[lowerGhost + offsets[n]] = 0.0;
+      field[upperGhost + offsets[n]] = 0.0;
+    }
+  }
+}
+
+template <int Dim>
+bool ParticleSimulation<Dim>::isInSubdomain(int p) const {
+  for (int d = 0; d < Dim; d++) {
+    const int index = particles_.getIndices(d)[p];
+    if (index < 2 || index >= parameters_.parallel.localSize[d] + 2) {
+      return false;
+    }
   }
+  return true;
+}
 
-  particles_.remove_if([this](Particle& particle) { return particle.getK() < 2; });
+template <int Dim>
+bool ParticleSimulation<Dim>::isInSubdomain(const std::array<int, Dim>& index) const {
+  for (int d = 0; d < Dim; d++) {
+    if (index[d] < 2 || index[d] >= parameters_.parallel.localSize[d] + 2) {
+      return false;
+    }
+  }
+  return true;
+}
 
-  if (sendBuffer.size() == 0)
-    sendBuffer.push_back(0.0);
-  return sendBuffer;
+template <int Dim>
+void ParticleSimulation<Dim>::communicateParticles() {
+  beginCommunicateParticles();
+  endCommunicateParticles();
 }
 
-std::vector<RealType> ParticleSimulation::collectBackBoundaryParticles() {
-  const int             dim = parameters_.geometry.dim;
-  std::vector<RealType> sendBuffer;
+template <int Dim>
+void ParticleSimulation<Dim>::beginCommunicateParticles() {
+  ASSERTION(!communicating_);
 
-  for (auto& particle : particles_) {
-    if (particle.getK() >= parameters_.parallel.localSize[2] + 2) { // back ghost cell territory
-      if (dim == 2) {
-        sendBuffer.push_back(particle.getX());
-        sendBuffer.push_back(particle.getY());
-        sendBuffer.push_back(particle.getU());
-        sendBuffer.push_back(particle.getV());
-        sendBuffer.push_back(static_cast<RealType>(particle.getI()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getJ()));
-      } else {
-        sendBuffer.push_back(particle.getX());
-        sendBuffer.push_back(particle.getY());
-        sendBuffer.push_back(particle.getZ());
-        sendBuffer.push_back(particle.getU());
-        sendBuffer.push_back(particle.getV());
-        sendBuffer.push_back(particle.getW());
-        sendBuffer.push_back(static_cast<RealType>(particle.getI()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getJ()));
-        sendBuffer.push_back(static_cast<RealType>(particle.getK()));
-      }
+  if (neighbourhood_ == MPI_COMM_NULL) {
+    initializeCommunication();
+  }
+
+  // Move the particles which left the subdomain during the advection into the outboxes. Removing a particle moves
+  // the last one into its slot, hence the migrants are removed from the back to keep the remaining positions valid.
+  std::sort(migrants_.begin(), migrants_.end(), std::greater<int>());
+  for (const int p : migrants_) {
+    Particle<Dim> particle = detachParticle(p);
+    particles_.remove(p);
+    routeParticle(particle);
+  }
+  migrants_.clear();
+
+  startExchange();
+  communicating_ = true;
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::endCommunicateParticles() {
+  if (!communicating_) {
+    return;
+  }
+
+  finishExchange();
+  communicating_ = false;
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::writeCheckpoint(int timeSteps, RealType timeInject) {
+  endCommunicateParticles();
+
+  ParticleCheckpoint::Checkpoint checkpoint;
+  ParticleCheckpoint::Header&    header = checkpoint.header;
+  header.dim                            = Dim;
+  header.ranks                          = parameters_.parallel.numProcessors[0] * parameters_.parallel.numProcessors[1];
+  if constexpr (Dim == 3) {
+    header.ranks *= parameters_.parallel.numProcessors[2];
+  }
+  header.timeSteps  = timeSteps;
+  header.time       = time_;
+  header.timeInject = timeInject;
+
+  checkpoint.injectionTimes.assign(injectionTimes_.begin(), injectionTimes_.end());
+  for (const auto& statistic : statistics_) {
+    checkpoint.sums.insert(checkpoint.sums.end(), statistic->getSums().begin(), statistic->getSums().end());
+  }
+
+  // The positions of the container are stored in full, also with compact positions
+  checkpoint.records.resize(particles_.size());
+  for (int p = 0; p < particles_.size(); p++) {
+    ParticleCheckpoint::Record& record = checkpoint.records[p];
+    record                             = {particles_.getIds()[p], particles_.getInjections()[p], {0, 0, 0}, {}, {}};
+    for (int d = 0; d < Dim; d++) {
+      record.index[d]    = particles_.getIndices(d)[p] + parameters_.parallel.firstCorner[d] - 2;
+      record.position[d] = particles_.getPositions(d)[p];
+      record.velocity[d] = particles_.getVelocities(d)[p];
     }
   }
 
-  particles_.remove_if([this](Particle& particle) { return particle.getK() >= parameters_.parallel.localSize[2] + 2; });
+  const std::string& prefix = parameters_.vtk.prefix;
+  const int          rank   = parameters_.parallel.rank;
+  ParticleCheckpoint::write(ParticleCheckpoint::getFileName(prefix, rank, timeSteps), checkpoint);
+  FlowFieldCheckpoint::write(FlowFieldCheckpoint::getFileName(prefix, rank, timeSteps), flowField_, parameters_);
 
-  if (sendBuffer.size() == 0)
-    sendBuffer.push_back(0.0);
-  return sendBuffer;
+  // The new generation is committed once all ranks have written their checkpoint, and the previous one is removed
+  // once the commit is visible to all ranks
+  MPI_Barrier(PETSC_COMM_WORLD);
+  if (rank == 0) {
+    ParticleCheckpoint::commit(prefix, timeSteps);
+  }
+  MPI_Barrier(PETSC_COMM_WORLD);
+  if (checkpointTimeSteps_ >= 0 && checkpointTimeSteps_ != timeSteps) {
+    std::filesystem::remove(ParticleCheckpoint::getFileName(prefix, rank, checkpointTimeSteps_));
+    std::filesystem::remove(FlowFieldCheckpoint::getFileName(prefix, rank, checkpointTimeSteps_));
+  }
+  checkpointTimeSteps_ = timeSteps;
 }
 
-void ParticleSimulation::communicateParticles() {
-  const int          dim              = parameters_.geometry.dim;
-  const unsigned int dimension_offset = (dim == 2) ? 6 : 9;
+template <int Dim>
+ParticleCheckpoint::State ParticleSimulation<Dim>::readCheckpoint(const std::string& prefix) {
+  ASSERTION(!communicating_);
+
+  // The clocks are the same on all ranks of the previous run, hence taken from the checkpoint of its first rank
+  const std::int64_t                   timeSteps = ParticleCheckpoint::readCommit(prefix);
+  const std::string                    firstName = ParticleCheckpoint::getFileName(prefix, 0, timeSteps);
+  const ParticleCheckpoint::Checkpoint first     = ParticleCheckpoint::read(firstName, false);
+  const ParticleCheckpoint::Header&    header    = first.header;
+  if (header.dim != Dim) {
+    throw std::runtime_error("The particle checkpoint was written by a simulation of another dimension");
+  }
+  injections_ = header.injections;
+  injectionTimes_.assign(first.injectionTimes.begin(), first.injectionTimes.end());
+  time_ = header.time;
 
-  // Collect buffers
-  std::vector<RealType> leftSendBuffer;
-  std::vector<RealType> rightSendBuffer;
-  std::vector<RealType> bottomSendBuffer;
-  std::vector<RealType> topSendBuffer;
-  std::vector<RealType> frontSendBuffer;
-  std::vector<RealType> backSendBuffer;
+  // Every rank restores its cells from the flow field checkpoints which overlap its subdomain
+  FlowFieldCheckpoint::read(prefix, header.ranks, timeSteps, flowField_, parameters_);
 
-  int leftSendCount;
-  int rightSendCount;
-  int bottomSendCount;
-  int topSendCount;
-  int frontSendCount;
-  int backSendCount;
+  std::size_t sums = 0;
+  for (const auto& statistic : statistics_) {
+    sums += statistic->getSums().size();
+  }
 
-  int leftRecvCount   = 0;
-  int rightRecvCount  = 0;
-  int bottomRecvCount = 0;
-  int topRecvCount    = 0;
-  int frontRecvCount  = 0;
-  int backRecvCount   = 0;
+  if (neighbourhood_ == MPI_COMM_NULL) {
+    initializeCommunication();
+  }
 
-  leftSendBuffer  = collectLeftBoundaryParticles();
-  rightSendBuffer = collectRightBoundaryParticles();
-  leftSendCount   = leftSendBuffer.size();
-  rightSendCount  = rightSendBuffer.size();
+  // The checkpoints of the previous run are dealt out to the ranks, which route the particles to their owners. The
+  // records which the previous run logged after the checkpoint are removed from the trajectory logs, which this run
+  // continues.
+  int nproc;
+  MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+  for (int rank = parameters_.parallel.rank; rank < header.ranks; rank += nproc) {
+    if (parameters_.particles.trajectoryStride > 0) {
+      ParticleTrajectory::truncate(ParticleTrajectory::getFileName(parameters_.vtk.prefix, rank), header.time);
+    }
 
-  MPI_Sendrecv(
-    &leftSendCount,
-    1,
-    MPI_INT,
-    parameters_.parallel.leftNb,
-    0,
-    &rightRecvCount,
-    1,
-    MPI_INT,
-    parameters_.parallel.rightNb,
-    0,
-    PETSC_COMM_WORLD,
-    MPI_STATUS_IGNORE
-  );
+    const std::string                    fileName   = ParticleCheckpoint::getFileName(prefix, rank, timeSteps);
+    const ParticleCheckpoint::Checkpoint checkpoint = ParticleCheckpoint::read(fileName);
+    if (checkpoint.header.timeSteps != header.timeSteps) {
+      throw std::runtime_error(fileName + " belongs to another time step than the other particle checkpoints");
+    }
+    if (checkpoint.sums.size() != sums) {
+      throw std::runtime_error(fileName + " was written with other particle statistics");
+    }
 
-  // send from right, receive on left
-  MPI_Sendrecv(
-    &rightSendCount,
-    1,
-    MPI_INT,
-    parameters_.parallel.rightNb,
-    1,
-    &leftRecvCount,
-    1,
-    MPI_INT,
-    parameters_.parallel.leftNb,
-    1,
-    PETSC_COMM_WORLD,
-    MPI_STATUS_IGNORE
-  );
+    // The sums of several ranks of the previous run add up on one rank of this run
+    auto sum = checkpoint.sums.begin();
+    for (auto& statistic : statistics_) {
+      for (double& value : statistic->getSums()) {
+        value += *sum++;
+      }
+    }
 
-  std::vector<RealType> leftRecvBuffer;
-  leftRecvBuffer.reserve(leftRecvCount);
+    for (const ParticleCheckpoint::Record& record : checkpoint.records) {
+      ParticlePositionType position[Dim];
+      RealType             velocity[Dim];
+      int                  index[Dim];
+      for (int d = 0; d < Dim; d++) {
+        RealType coordinate = record.position[d];
+#ifdef ENABLE_COMPACT_PARTICLE_POSITIONS
+        coordinate -= getCellStart(d, record.index[d] - parameters_.parallel.firstCorner[d] + 2);
+#endif
+        position[d] = static_cast<ParticlePositionType>(coordinate);
+        velocity[d] = record.velocity[d];
+        index[d]    = record.index[d];
+      }
+      Particle<Dim> particle(position, velocity, index, record.injection, record.id);
+      routeParticle(particle);
+    }
+  }
 
-  std::vector<RealType> rightRecvBuffer;
-  rightRecvBuffer.reserve(rightRecvCount);
+  startExchange();
+  communicating_ = true;
+  endCommunicateParticles();
 
-  MPI_Sendrecv(
-    leftSendBuffer.data(),
-    leftSendCount,
-    MY_MPI_FLOAT,
-    parameters_.parallel.leftNb,
-    0,
-    rightRecvBuffer.data(),
-    rightRecvCount,
-    MY_MPI_FLOAT,
-    parameters_.parallel.rightNb,
-    0,
-    PETSC_COMM_WORLD,
-    MPI_STATUS_IGNORE
-  );
+  return {static_cast<int>(header.timeSteps), header.time, header.timeInject};
+}
 
-  // send from right, receive on left
-  MPI_Sendrecv(
-    rightSendBuffer.data(),
-    rightSendCount,
-    MY_MPI_FLOAT,
-    parameters_.parallel.rightNb,
-    1,
-    leftRecvBuffer.data(),
-    leftRecvCount,
-    MY_MPI_FLOAT,
-    parameters_.parallel.leftNb,
-    1,
-    PETSC_COMM_WORLD,
-    MPI_STATUS_IGNORE
-  );
+template <int Dim>
+void ParticleSimulation<Dim>::countParticles(std::array<std::vector<int>, 3>& layerCounts) const {
+  const int geometrySizes[3] = {parameters_.geometry.sizeX, parameters_.geometry.sizeY, parameters_.geometry.sizeZ};
+  for (int d = 0; d < 3; d++) {
+    layerCounts[d].assign((d < Dim) ? geometrySizes[d] : 0, 0);
+  }
 
-  if (leftRecvCount > 1) {
-    for (int i = 0; i < leftRecvCount / dimension_offset; i++) {
-      Particle particle(&leftRecvBuffer[i * dimension_offset], flowField_, parameters_);
-      particle.getI() = 2;
-      particles_.push_front(particle);
+  for (int d = 0; d < Dim; d++) {
+    const int* indices = particles_.getIndices(d);
+    for (int p = 0; p < particles_.size(); p++) {
+      layerCounts[d][indices[p] + parameters_.parallel.firstCorner[d] - 2]++;
     }
   }
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::suspendParticles() {
+  endCommunicateParticles();
+
+  // The cell indices are stored in the global numbering, which stays valid when the subdomains move
+  suspended_.clear();
+  suspended_.reserve(particles_.size());
+  for (int p = 0; p < particles_.size(); p++) {
+    suspended_.push_back(detachParticle(p));
+  }
+  particles_.clear();
+  migrants_.clear();
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::adoptParticles(ParticleSimulationBase& previous) {
+  ASSERTION(!communicating_);
+
+  ParticleSimulation<Dim>& source = dynamic_cast<ParticleSimulation<Dim>&>(previous);
+  injections_                     = source.injections_;
+  stepsSinceSort_                 = source.stepsSinceSort_;
+  time_                           = source.time_;
+  injectionTimes_                 = source.injectionTimes_;
+  checkpointTimeSteps_            = source.checkpointTimeSteps_;
+  trajectoryFile_                 = std::move(source.trajectoryFile_);
+  statistics_                     = std::move(source.statistics_);
+
+  if (neighbourhood_ == MPI_COMM_NULL) {
+    initializeCommunication();
+  }
+
+  // The previous owner may lie several subdomains away from the current one, the exchange sends these directly
+  for (Particle<Dim>& particle : source.suspended_) {
+    routeParticle(particle);
+  }
+  source.suspended_.clear();
+
+  startExchange();
+  communicating_ = true;
+  endCommunicateParticles();
+}
 
-  if (rightRecvCount > 1) {
-    for (int i = 0; i < rightRecvCount / dimension_offset; i++) {
-      Particle particle(&rightRecvBuffer[i * dimension_offset], flowField_, parameters_);
-      particle.getI() = parameters_.parallel.localSize[0] + 1;
-      particles_.push_front(particle);
+template <int Dim>
+void ParticleSimulation<Dim>::initializeCommunication() {
+  // First global cell of every subdomain along each axis
+  int              nproc;
+  std::vector<int> corners;
+  MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+  corners.resize(6 * nproc);
+  int localCorner[6] = {
+    parameters_.parallel.indices[0],
+    parameters_.parallel.indices[1],
+    parameters_.parallel.indices[2],
+    parameters_.parallel.firstCorner[0],
+    parameters_.parallel.firstCorner[1],
+    parameters_.parallel.firstCorner[2]};
+  MPI_Allgather(localCorner, 6, MPI_INT, corners.data(), 6, MPI_INT, PETSC_COMM_WORLD);
+  for (int d = 0; d < Dim; d++) {
+    subdomainStarts_[d].resize(parameters_.parallel.numProcessors[d]);
+    for (int r = 0; r < nproc; r++) {
+      subdomainStarts_[d][corners[6 * r + d]] = corners[6 * r + 3 + d];
     }
   }
 
-  bottomSendBuffer = collectBottomBoundaryParticles();
-  topSendBuffer    = collectTopBoundaryParticles();
-  bottomSendCount  = bottomSendBuffer.size();
-  topSendCount     = topSendBuffer.size();
+  // The graph communicator keeps the ranks of PETSC_COMM_WORLD, distant particles are sent to these
+  const int* processors = parameters_.parallel.numProcessors;
+  subdomainRanks_.resize(nproc);
+  for (int r = 0; r < nproc; r++) {
+    subdomainRanks_[corners[6 * r] + processors[0] * (corners[6 * r + 1] + processors[1] * corners[6 * r + 2])] = r;
+  }
 
-  MPI_Sendrecv(
-    &bottomSendCount,
-    1,
-    MPI_INT,
-    parameters_.parallel.bottomNb,
-    2,
-    &topRecvCount,
-    1,
-    MPI_INT,
-    parameters_.parallel.topNb,
-    2,
-    PETSC_COMM_WORLD,
-    MPI_STATUS_IGNORE
-  );
+  // All existing neighbours, including the ones across edges and corners, become the neighbourhood of the
+  // subdomain. The neighbour relation is symmetric, so every rank sends to and receives from the same ranks.
+  neighbourSlots_.fill(-1);
+  neighbours_.clear();
+  for (int slot = 0; slot < 27; slot++) {
+    const int neighbour = parameters_.parallel.neighbours[slot];
+    if (slot != 13 && neighbour != MPI_PROC_NULL) { // Slot 13 is the subdomain itself
+      neighbourSlots_[slot] = neighbours_.size();
+      neighbours_.push_back(neighbour);
+    }
+  }
 
-  // send from top, receive on bottom
-  MPI_Sendrecv(
-    &topSendCount,
-    1,
-    MPI_INT,
-    parameters_.parallel.topNb,
-    3,
-    &bottomRecvCount,
-    1,
-    MPI_INT,
-    parameters_.parallel.bottomNb,
-    3,
+  MPI_Dist_graph_create_adjacent(
     PETSC_COMM_WORLD,
-    MPI_STATUS_IGNORE
+    neighbours_.size(),
+    neighbours_.data(),
+    MPI_UNWEIGHTED,
+    neighbours_.size(),
+    neighbours_.data(),
+    MPI_UNWEIGHTED,
+    MPI_INFO_NULL,
+    0,
+    &neighbourhood_
   );
 
-  std::vector<RealType> bottomRecvBuffer;
-  bottomRecvBuffer.reserve(bottomRecvCount);
-
-  std::vector<RealType> topRecvBuffer;
-  topRecvBuffer.reserve(topRecvCount);
-
-  MPI_Sendrecv(
-    bottomSendBuffer.data(),
-    bottomSendCount,
-    MY_MPI_FLOAT,
-    parameters_.parallel.bottomNb,
-    2,
-    topRecvBuffer.data(),
-    topRecvCount,
-    MY_MPI_FLOAT,
-    parameters_.parallel.topNb,
-    2,
-    PETSC_COMM_WORLD,
-    MPI_STATUS_IGNORE
-  );
+  particleType_ = Particle<Dim>::createMPIDatatype();
 
-  // send from top, receive on bottom
-  MPI_Sendrecv(
-    topSendBuffer.data(),
-    topSendCount,
-    MY_MPI_FLOAT,
-    parameters_.parallel.topNb,
-    3,
-    bottomRecvBuffer.data(),
-    bottomRecvCount,
-    MY_MPI_FLOAT,
-    parameters_.parallel.bottomNb,
-    3,
-    PETSC_COMM_WORLD,
-    MPI_STATUS_IGNORE
+  outboxes_.resize(neighbours_.size());
+  sendCounts_.resize(neighbours_.size());
+  recvCounts_.resize(neighbours_.size());
+  sendDispls_.resize(neighbours_.size());
+  recvDispls_.resize(neighbours_.size());
+}
+
+template <int Dim>
+Particle<Dim> ParticleSimulation<Dim>::detachParticle(int p) {
+  ParticlePositionType position[Dim];
+  RealType             velocity[Dim];
+  int                  globalIndex[Dim];
+
+  for (int d = 0; d < Dim; d++) {
+    const int index      = particles_.getIndices(d)[p];
+    RealType  coordinate = particles_.getPositions(d)[p];
+#ifdef ENABLE_COMPACT_PARTICLE_POSITIONS
+    coordinate -= getCellStart(d, index);
+#endif
+    position[d]    = static_cast<ParticlePositionType>(coordinate);
+    velocity[d]    = particles_.getVelocities(d)[p];
+    globalIndex[d] = index + parameters_.parallel.firstCorner[d] - 2;
+  }
+
+  return Particle<Dim>(position, velocity, globalIndex, particles_.getInjections()[p], particles_.getIds()[p]);
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::attachParticle(const Particle<Dim>& particle) {
+  std::array<RealType, Dim> position;
+  std::array<RealType, Dim> velocity;
+  std::array<int, Dim>      index;
+
+  for (int d = 0; d < Dim; d++) {
+    index[d]    = particle.getIndex(d) - parameters_.parallel.firstCorner[d] + 2;
+    position[d] = particle.getPosition(d);
+#ifdef ENABLE_COMPACT_PARTICLE_POSITIONS
+    position[d] += getCellStart(d, index[d]);
+#endif
+    velocity[d] = particle.getVelocity(d);
+  }
+
+  particles_.add(position, velocity, index, particle.getInjection(), particle.getId());
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::routeParticle(Particle<Dim>& particle) {
+  const int geometrySizes[3] = {parameters_.geometry.sizeX, parameters_.geometry.sizeY, parameters_.geometry.sizeZ};
+  int       owner[3]         = {0, 0, 0};
+  int       offset[3]        = {0, 0, 0};
+  bool      distant          = false;
+
+  for (int d = 0; d < Dim; d++) {
+    const int cell = particle.getIndex(d);
+
+    // The particle left the domain
+    if (cell < 0 || cell >= geometrySizes[d]) {
+      for (auto& statistic : statistics_) {
+        statistic->exit(time_ - injectionTimes_[particle.getInjection()]);
+      }
+      return;
+    }
+
+    // Subdomains along the axis, counted from the one of this rank, up to the owner of the cell
+    const std::vector<int>& starts = subdomainStarts_[d];
+    owner[d]                       = std::upper_bound(starts.begin(), starts.end(), cell) - starts.begin() - 1;
+    offset[d]                      = std::clamp(owner[d] - parameters_.parallel.indices[d], -1, 1);
+    distant                        = distant || owner[d] != parameters_.parallel.indices[d] + offset[d];
+  }
+
+  if (distant) {
+    const int* processors = parameters_.parallel.numProcessors;
+    const int  rank       = subdomainRanks_[owner[0] + processors[0] * (owner[1] + processors[1] * owner[2])];
+    distantOutboxes_[rank].push_back(particle);
+  } else if (offset[0] == 0 && offset[1] == 0 && offset[2] == 0) {
+    attachParticle(particle);
+  } else {
+    const int slot = (offset[0] + 1) + 3 * (offset[1] + 1) + 9 * (offset[2] + 1);
+    outboxes_[neighbourSlots_[slot]].push_back(particle);
+  }
+}
+
+template <int Dim>
+void ParticleSimulation<Dim>::startExchange() {
+  // Flatten the outboxes into the send buffer
+  sendBuffer_.clear();
+  for (std::size_t n = 0; n < outboxes_.size(); n++) {
+    sendCounts_[n] = outboxes_[n].size();
+    sendDispls_[n] = sendBuffer_.size();
+    sendBuffer_.insert(sendBuffer_.end(), outboxes_[n].begin(), outboxes_[n].end());
+    outboxes_[n].clear();
+  }
+
+  MPI_Ineighbor_alltoall(
+    sendCounts_.data(), 1, MPI_INT, recvCounts_.data(), 1, MPI_INT, neighbourhood_, &requests_[0]
   );
 
-  if (bottomRecvCount > 1) {
-    for (int i = 0; i < bottomRecvCount / dimension_offset; i++) {
-      Particle particle(&bottomRecvBuffer[i * dimension_offset], flowField_, parameters_);
-      particle.getJ() = 2;
-      particles_.push_front(particle);
-    }
-  }
-  if (topRecvCount > 1) {
-    for (int i = 0; i < topRecvCount / dimension_offset; i++) {
-      Particle particle(&topRecvBuffer[i * dimension_offset], flowField_, parameters_);
-      particle.getJ() = parameters_.parallel.localSize[1] + 1;
-      particles_.push_front(particle);
-    }
-  }
-
-  if (dim == 3) {
-    frontSendBuffer = collectFrontBoundaryParticles();
-    backSendBuffer  = collectBackBoundaryParticles();
-    frontSendCount  = frontSendBuffer.size();
-    backSendCount   = backSendBuffer.size();
-
-    // send from front, receive on back
-    MPI_Sendrecv(
-      &frontSendCount,
-      1,
-      MPI_INT,
-      parameters_.parallel.frontNb,
-      4,
-      &backRecvCount,
-      1,
-      MPI_INT,
-      parameters_.parallel.backNb,
-      4,
-      PETSC_COMM_WORLD,
-      MPI_STATUS_IGNORE
+  // The particles of distant owners are sent to them directly. Consecutive exchanges alternate between two tags, as
+  // a rank may start the next exchange while a distant owner is still receiving the particles of this one.
+  exchanges_++;
+  distantRequests_.resize(distantOutboxes_.size());
+  int request = 0;
+  for (auto& [rank, particles] : distantOutboxes_) {
+    MPI_Issend(
+      particles.data(),
+      particles.size(),
+      particleType_,
+      rank,
+      DISTANT_TAG + exchanges_ % 2,
+      neighbourhood_,
+      &distantRequests_[request++]
     );
+  }
+}
 
-    // send from back, receive on front
-    MPI_Sendrecv(
-      &backSendCount,
-      1,
-      MPI_INT,
-      parameters_.parallel.backNb,
-      5,
-      &frontRecvCount,
-      1,
-      MPI_INT,
-      parameters_.parallel.frontNb,
-      5,
-      PETSC_COMM_WORLD,
-      MPI_STATUS_IGNORE
-    );
+template <int Dim>
+void ParticleSimulation<Dim>::finishExchange() {
+  // The outboxes can only be received once their sizes are known. The particles of the neighbours travel while the
+  // distant particles are received.
+  MPI_Wait(&requests_[0], MPI_STATUS_IGNORE);
+  int recvSize = 0;
+  for (std::size_t n = 0; n < neighbours_.size(); n++) {
+    recvDispls_[n] = recvSize;
+    recvSize += recvCounts_[n];
+  }
+  recvBuffer_.resize(recvSize);
+
+  MPI_Ineighbor_alltoallv(
+    sendBuffer_.data(),
+    sendCounts_.data(),
+    sendDispls_.data(),
+    particleType_,
+    recvBuffer_.data(),
+    recvCounts_.data(),
+    recvDispls_.data(),
+    particleType_,
+    neighbourhood_,
+    &requests_[1]
+  );
 
-    std::vector<RealType> frontRecvBuffer;
-    frontRecvBuffer.reserve(frontRecvCount);
-
-    std::vector<RealType> backRecvBuffer;
-    backRecvBuffer.reserve(backRecvCount);
-
-    // send from front, receive on back
-    MPI_Sendrecv(
-      frontSendBuffer.data(),
-      frontSendCount,
-      MY_MPI_FLOAT,
-      parameters_.parallel.frontNb,
-      4,
-      backRecvBuffer.data(),
-      backRecvCount,
-      MY_MPI_FLOAT,
-      parameters_.parallel.backNb,
-      4,
-      PETSC_COMM_WORLD,
-      MPI_STATUS_IGNORE
-    );
+  receiveDistantParticles();
+  MPI_Wait(&requests_[1], MPI_STATUS_IGNORE);
 
-    // send from back, receive on front
-    MPI_Sendrecv(
-      backSendBuffer.data(),
-      backSendCount,
-      MY_MPI_FLOAT,
-      parameters_.parallel.backNb,
-      5,
-      frontRecvBuffer.data(),
-      frontRecvCount,
-      MY_MPI_FLOAT,
-      parameters_.parallel.frontNb,
-      5,
-      PETSC_COMM_WORLD,
-      MPI_STATUS_IGNORE
-    );
+  // Received particles are always taken over, also beyond the budget, which only limits the injections
+  for (Particle<Dim>& particle : recvBuffer_) {
+    routeParticle(particle);
+  }
+}
 
-    if (backRecvCount > 1) {
-      for (int i = 0; i < backRecvCount / dimension_offset; i++) {
-        Particle particle(&backRecvBuffer[i * dimension_offset], flowField_, parameters_);
-        particle.getK() = 2;
-        particles_.push_front(particle);
+template <int Dim>
+void ParticleSimulation<Dim>::receiveDistantParticles() {
+  const int   tag     = DISTANT_TAG + exchanges_ % 2;
+  MPI_Request barrier = MPI_REQUEST_NULL;
+  int         done    = 0;
+  while (!done) {
+    int        arrived;
+    MPI_Status status;
+    MPI_Iprobe(MPI_ANY_SOURCE, tag, neighbourhood_, &arrived, &status);
+    if (arrived) {
+      int count;
+      MPI_Get_count(&status, particleType_, &count);
+      distantBuffer_.resize(count);
+      MPI_Recv(
+        distantBuffer_.data(), count, particleType_, status.MPI_SOURCE, tag, neighbourhood_, MPI_STATUS_IGNORE
+      );
+      for (Particle<Dim>& particle : distantBuffer_) {
+        routeParticle(particle);
       }
     }
 
-    if (frontRecvCount > 1) {
-      for (int i = 0; i < frontRecvCount / dimension_offset; i++) {
-        Particle particle(&frontRecvBuffer[i * dimension_offset], flowField_, parameters_);
-        particle.getK() = parameters_.parallel.localSize[2] + 1;
-        particles_.push_front(particle);
+    if (barrier == MPI_REQUEST_NULL) {
+      int sent;
+      MPI_Testall(distantRequests_.size(), distantRequests_.data(), &sent, MPI_STATUSES_IGNORE);
+      if (sent) {
+        MPI_Ibarrier(neighbourhood_, &barrier);
       }
+    } else {
+      MPI_Test(&barrier, &done, MPI_STATUS_IGNORE);
     }
   }
-}
\ No newline at end of file
+  distantOutboxes_.clear();
+}
+
+template class ParticleSimulation<2>;
+template class ParticleSimulation<3>;
@@ -5,24 +5,299 @@
 #include "FlowField.hpp"
 #include "Parameters.hpp"
 #include "Particle.hpp"
+#include "ParticleCheckpoint.hpp"
+#include "ParticleContainer.hpp"
+#include "ParticleStatistics.hpp"
+#include "ParticleTrajectory.hpp"
+
+/** Interface of the particle simulation, independent of the dimension it is compiled for */
+class ParticleSimulationBase {
+public:
+  virtual ~ParticleSimulationBase() = default;
+
+  virtual void initializeParticles()        = 0;
+  virtual void solveTimestep()              = 0;
+  virtual int  getNumberOfParticles() const = 0;
+
+  /** Moves all particles by one time step, using all OpenMP threads
+   *
+   * The particles which leave the subdomain are recorded for the next beginCommunicateParticles().
+   */
+  virtual void advectParticles(RealType dt) = 0;
+
+  /** Writes the particles of the subdomain with their velocities and identifiers to a binary VTK XML PolyData file
+   *
+   * Rank 0 additionally writes the .pvtp file which joins the files of all ranks of the time step.
+   */
+  virtual void plot(int timeSteps, RealType time) = 0;
+  virtual void communicateParticles()             = 0;
+
+  /** Appends the particles of the subdomain to the trajectory log of the rank at every trajectoryStride-th time step
+   *
+   * Has to be called while no particle is in flight, i.e. before beginCommunicateParticles() or after
+   * endCommunicateParticles(), so that every particle is recorded by exactly one rank.
+   */
+  virtual void recordTrajectories(int timeSteps, RealType time) = 0;
+
+  /** Deposits the particles of the subdomain onto the concentration field of the flow field
+   *
+   * Does nothing unless a deposit scheme is configured. Like recordTrajectories(), it has to be called while no
+   * particle is in flight. The deposit near the subdomain boundaries is exchanged with the neighbours, hence it has
+   * to be called by all processes.
+   */
+  virtual void depositParticles() = 0;
+
+  /** Reduces the particle statistics of all ranks and writes them on rank 0. Has to be called by all processes. */
+  virtual void writeStatistics(int timeSteps, RealType time) = 0;
+
+  /** Writes the particles of the subdomain, the injection clock and the statistics to the checkpoint of the rank. Has
+   * to be called by all processes.
+   *
+   * Completes a pending exchange first. The pressure and the velocity of the subdomain are checkpointed along with the
+   * particles. Once all ranks have written their checkpoints, rank 0 commits the checkpoints of the time step, and
+   * every rank removes its previous checkpoints.
+   *
+   * @param timeInject Time of the next injection
+   */
+  virtual void writeCheckpoint(int timeSteps, RealType timeInject) = 0;
+
+  /** Restarts from the checkpoints of a previous run, instead of the first injection. Has to be called by all
+   * processes.
+   *
+   * The previous run may have used a different number of ranks. Rank r reads the last committed checkpoints of the
+   * ranks r, r + nproc, ... of the previous run and hands the particles to their owners. Every rank restores the
+   * inner cells of its subdomain from the flow field checkpoints; the ghost layers have to be communicated afterwards.
+   *
+   * @param prefix VTK prefix of the previous run
+   * @return State of the time loop at the checkpoint
+   */
+  virtual ParticleCheckpoint::State readCheckpoint(const std::string& prefix) = 0;
+
+  /** Split-phase version of communicateParticles()
+   *
+   * beginCommunicateParticles() moves the particles which left the subdomain into the outboxes, starts sending the
+   * outbox sizes to the neighbours and the particles to distant owners, and returns without waiting for any of them.
+   * endCommunicateParticles() exchanges the outboxes with the neighbours and completes the exchange; it returns
+   * immediately if no exchange is pending. The particles in flight belong to no subdomain in between, so the exchange
+   * has to be completed before the particles are plotted or advected again. The flow field may be changed in between.
+   *
+   * Every particle reaches its owner within one exchange: the neighbours get theirs through the neighbourhood
+   * collective, owners further away directly from the rank the particle left. Both have to be called by all
+   * processes.
+   */
+  virtual void beginCommunicateParticles() = 0;
+  virtual void endCommunicateParticles()   = 0;
+
+  /** Counts the particles of the subdomain in every global layer of cells along each axis, for the load balancer */
+  virtual void countParticles(std::array<std::vector<int>, 3>& layerCounts) const = 0;
+
+  /** Takes all particles out of the subdomain before its boundaries move, completing a pending exchange first */
+  virtual void suspendParticles() = 0;
+
+  /** Takes over the particles, injections and trajectory log of a particle simulation of the previous subdomains
+   *
+   * The particles suspended by the previous simulation are handed to their owners among the current subdomains. Has
+   * to be called by all processes.
+   */
+  virtual void adoptParticles(ParticleSimulationBase& previous) = 0;
+};
+
+/** Tracer particles of a 2D or 3D simulation
+ *
+ * The dimension is a template parameter, so that the particle kernels do not branch on it and 2D particles neither
+ * store nor send a third component. Both dimensions are instantiated in ParticleSimulation.cpp.
+ */
+template <int Dim>
+class ParticleSimulation: public ParticleSimulationBase {
+  static_assert(Dim == 2 || Dim == 3, "Particles only exist in 2D and 3D");
 
-class ParticleSimulation {
 private:
-  Parameters&         parameters_;
-  FlowField&          flowField_;
-  std::list<Particle> particles_;
+  static constexpr int DISTANT_TAG = 1; //! Tag of the particles sent to owners beyond the neighbours
+
+  Parameters&            parameters_;
+  FlowField&             flowField_;
+  ParticleContainer<Dim> particles_;
+  ParticleContainer<Dim> seeds_;               //! Particles owned by the subdomain which every injection adds
+  std::vector<int>       migrants_;            //! Particles which left the subdomain during the last advection
+  int                    stepsSinceSort_;      //! Advections since the particles were last sorted by cell
+  int                    injections_;          //! Number of injections so far
+  RealType               time_;                //! Time the particles were advected for
+  std::vector<RealType>  injectionTimes_;      //! Time of every injection
+  std::int64_t           checkpointTimeSteps_; //! Time step of the last checkpoint of the rank, -1 for none
+
+  //! Reflections of the particles at each wall and at the obstacles
+  using Hits = std::array<std::int64_t, ParticleStatistics::NUMBER_OF_REGIONS>;
+
+  //! Migrants and wall hits found by one thread during the advection, padded to a cache line against false sharing
+  struct alignas(CACHE_LINE_SIZE) ThreadMigrants {
+    std::vector<int> particles;
+    Hits             hits;
+  };
+  std::vector<ThreadMigrants> threadMigrants_;
+
+  std::array<std::array<bool, 2>, Dim> walls_;   //! Whether the lower/upper domain boundary along each axis reflects
+  std::array<RealType, Dim>            lengths_; //! Length of the domain along each axis
+
+  bool cloudInCell_; //! Whether the particles are deposited with cloud-in-cell instead of nearest-grid-point weights
+
+  bool                    retainVelocity_;   //! Whether the velocity is interpolated in time between two fields
+  AlignedVector<RealType> previousVelocity_; //! Velocity field at the beginning of the time step
+
+  std::array<AlignedVector<RealType>, Dim> cellStarts_;      //! Lower coordinate of every local cell along each axis
+  std::array<AlignedVector<RealType>, Dim> inverseSpacings_; //! Reciprocal mesh size of every local cell
+
+  MPI_Comm                                  neighbourhood_;   //! Graph communicator of the subdomain and its neighbours
+  MPI_Datatype                              particleType_;    //! MPI datatype of a Particle
+  std::vector<int>                          neighbours_;      //! Ranks of the neighbours in the order of neighbourhood_
+  std::array<int, 27>                       neighbourSlots_;  //! Position in neighbours_, indexed like neighbours
+  std::array<std::vector<int>, Dim>         subdomainStarts_; //! First global cell of the subdomains along each axis
+  std::vector<int>                          subdomainRanks_;  //! Rank of every subdomain, indexed i + nx * (j + ny * k)
+  std::vector<std::vector<Particle<Dim>>>   outboxes_;        //! Particles to be sent to each neighbour
+  std::vector<Particle<Dim>>                sendBuffer_;
+  std::vector<Particle<Dim>>                recvBuffer_;
+  std::vector<int>                          sendCounts_;
+  std::vector<int>                          recvCounts_;
+  std::vector<int>                          sendDispls_;
+  std::vector<int>                          recvDispls_;
+  std::array<MPI_Request, 2>                requests_;        //! Requests for the counts and the particles
+  std::map<int, std::vector<Particle<Dim>>> distantOutboxes_; //! Particles to be sent to owners beyond the neighbours
+  std::vector<MPI_Request>                  distantRequests_; //! Synchronous sends of the distant outboxes
+  std::vector<Particle<Dim>>                distantBuffer_;   //! Particles received from beyond the neighbours
+  int                                       exchanges_;       //! Exchanges started, whose parity tells their tags apart
+  bool                                      communicating_;   //! Whether an exchange has been started but not completed
+
+  std::vector<Particle<Dim>>              suspended_;         //! Particles taken out by suspendParticles()
+  std::ofstream                           trajectoryFile_;    //! Trajectory log of the rank, opened on the first record
+  std::vector<ParticleTrajectory::Record> trajectoryRecords_; //! Records of the last recorded time step
+  std::vector<RealType>                   plotPositions_;     //! Interleaved coordinates of the last plot
+  std::vector<RealType>                   plotVelocities_;    //! Interleaved velocities of the last plot
+
+  ParticleStatistics::Statistics statistics_;     //! Statistics accumulated by every advection
+  std::vector<RealType>          speeds_;         //! Speeds of the particles for the statistics
+  std::vector<RealType>          residenceTimes_; //! Residence times of the particles for the statistics
+
+  void        updateParticle(int p, RealType dt, Hits& hits);                // move particle p and update its cell
+  inline void wallCorrect(RealType& x, RealType xLimit, RealType& velocity); // helper function for boundary conditions
+
+  /** Reflects particle p at the walls of the domain and at the obstacles given by the flag field
+   *
+   * A particle which ended up in an obstacle cell is reflected at the faces of the cell it came from which border the
+   * obstacle, as given by the OBSTACLE_LEFT/RIGHT/... bits of that cell.
+   *
+   * @param previousIndex Index of the cell the particle was in before it moved
+   * @param hits Counters of the walls and obstacles, incremented for every reflection
+   */
+  void applyBoundaryCondition(int p, const std::array<int, Dim>& previousIndex, Hits& hits);
+
+  /** Flags of a local cell, or 0 for cells outside of the flag field */
+  int getFlags(const std::array<int, Dim>& index) const;
+
+  /** Interpolates the flow velocity at count positions
+   *
+   * The positions are processed in SIMD lanes, with the velocities gathered from the raw field and the mesh taken
+   * from cellStarts_ and inverseSpacings_. Without a SIMD instruction set, the loop runs scalar. The velocity is
+   * interpolated linearly in time between the previous field (theta = 0) and the current one (theta = 1). Without a
+   * retained previous field, the current one is used.
+   *
+   * @param indices Cells of the positions, which have to lie inside the local field without its first layer
+   */
+  void interpolateVelocities(
+    int                                     count,
+    const std::array<const RealType*, Dim>& positions,
+    const std::array<const int*, Dim>&      indices,
+    RealType                                theta,
+    const std::array<RealType*, Dim>&       velocities
+  );
+
+  /** Moves particles first to last - 1 by one time step with the configured integrator
+   *
+   * The time step is split into sub-steps such that no particle moves further than the particle CFL number of cells
+   * in one of them. Particles which leave the local field during a sub-step see the velocity extrapolated from its
+   * border.
+   */
+  void integrateParticles(int first, int last, RealType dt, Hits& hits);
+
+  /** Copies the current velocity field into previousVelocity_ */
+  void retainVelocity();
+
+  /** Removes the given number of particles, starting with the ones of the earliest injection */
+  void removeOldestParticles(int count);
+
+  /** Lower coordinate of a cell along axis d, also for cells beyond the ghost layers */
+  RealType getCellStart(int d, int index) const;
+
+  /** Whether particle p is in the subdomain, ghost layers excluded */
+  bool isInSubdomain(int p) const;
+  bool isInSubdomain(const std::array<int, Dim>& index) const;
+
+  /** Adds the deposit in the ghost layers of the concentration to the subdomains owning these cells
+   *
+   * Runs along one axis after the other, as the halo exchange of the flow field does, but in reverse. Deposit beyond
+   * the domain boundaries is added to the boundary cells. Has to be called by all processes.
+   */
+  void foldGhostLayers();
+
+  /** Computes the seeds of the injections which fall into the subdomain */
+  void computeSeeds();
+  void initializeCommunication();
+
+  /** Copies particle p out of the container, with its cell index in the global numbering of the cells */
+  Particle<Dim> detachParticle(int p);
+
+  /** Adds a particle owned by the subdomain to the container */
+  void attachParticle(const Particle<Dim>& particle);
+
+  /** Adds a particle to the subdomain if it owns the particle, otherwise puts it into the outbox of the owner, which
+   * is either a neighbour or a distant subdomain. Particles which left the domain are dropped.
+   *
+   * @param particle Particle whose cell index is given in the global numbering of the cells
+   */
+  void routeParticle(Particle<Dim>& particle);
+
+  /** Starts sending the outbox sizes to all neighbours and the particles to distant owners */
+  void startExchange();
+
+  /** Exchanges the outboxes with the neighbours once the sizes have arrived, receives the particles of distant ranks
+   * and routes the received particles
+   */
+  void finishExchange();
+
+  /** Receives the particles sent by startExchange() to owners beyond the neighbours
+   *
+   * No rank knows how many distant ranks send to it. Every rank receives whatever arrives and enters a nonblocking
+   * barrier once all of its own synchronous sends have been received. The barrier completes once all ranks are there,
+   * and then every distant particle of the exchange has been received.
+   */
+  void receiveDistantParticles();
 
 public:
   ParticleSimulation(Parameters& parameters, FlowField& flowField);
 
-  void                  initializeParticles();
-  void                  solveTimestep();
-  void                  plot(int timeSteps, RealType time);
-  void                  communicateParticles();
-  std::vector<RealType> collectLeftBoundaryParticles();
-  std::vector<RealType> collectRightBoundaryParticles();
-  std::vector<RealType> collectBottomBoundaryParticles();
-  std::vector<RealType> collectTopBoundaryParticles();
-  std::vector<RealType> collectFrontBoundaryParticles();
-  std::vector<RealType> collectBackBoundaryParticles();
-};
\ No newline at end of file
+  /** Does not complete a pending exchange, which needs all ranks. endCommunicateParticles() has to be called before. */
+  virtual ~ParticleSimulation() override;
+
+  ParticleSimulation(const ParticleSimulation&)            = delete;
+  ParticleSimulation& operator=(const ParticleSimulation&) = delete;
+
+  virtual void initializeParticles() override;
+  virtual void solveTimestep() override;
+  virtual int  getNumberOfParticles() const override;
+
+  const ParticleContainer<Dim>&         getParticles() const;
+  const ParticleStatistics::Statistics& getStatistics() const;
+
+  virtual void advectParticles(RealType dt) override;
+  virtual void plot(int timeSteps, RealType time) override;
+  virtual void recordTrajectories(int timeSteps, RealType time) override;
+  virtual void depositParticles() override;
+  virtual void writeStatistics(int timeSteps, RealType time) override;
+  virtual void writeCheckpoint(int timeSteps, RealType timeInject) override;
+  virtual void communicateParticles() override;
+  virtual void beginCommunicateParticles() override;
+  virtual void endCommunicateParticles() override;
+  virtual void countParticles(std::array<std::vector<int>, 3>& layerCounts) const override;
+  virtual void suspendParticles() override;
+  virtual void adoptParticles(ParticleSimulationBase& previous) override;
+
+  virtual ParticleCheckpoint::State readCheckpoint(const std::string& prefix) override;
+};
@@ -0,0 +1,139 @@
+#include "StdAfx.hpp"
+
+#include "ParticleStatistics.hpp"
+
+ParticleStatistics::Statistic::Statistic(std::size_t numberOfSums):
+  sums_(numberOfSums, 0.0) {}
+
+void ParticleStatistics::Statistic::sample(const Sample& /*sample*/) {}
+
+void ParticleStatistics::Statistic::exit(RealType /*residenceTime*/) {}
+
+std::vector<double>& ParticleStatistics::Statistic::getSums() { return sums_; }
+
+ParticleStatistics::ResidenceTimeHistogram::ResidenceTimeHistogram(RealType binWidth, int bins):
+  Statistic(bins),
+  binWidth_(binWidth) {
+
+  if (binWidth <= 0.0 || bins < 1) {
+    throw std::runtime_error("The residence time histogram needs a positive bin width and at least one bin");
+  }
+}
+
+std::string ParticleStatistics::ResidenceTimeHistogram::getName() const { return "residence"; }
+
+void ParticleStatistics::ResidenceTimeHistogram::exit(RealType residenceTime) {
+  const RealType bin = std::max<RealType>(residenceTime / binWidth_, 0.0);
+  sums_[std::min(static_cast<std::size_t>(bin), sums_.size() - 1)] += 1.0;
+}
+
+void ParticleStatistics::ResidenceTimeHistogram::write(std::ostream& file, const std::vector<double>& sums) const {
+  file << "{\"binWidth\": " << binWidth_ << ", \"counts\": [";
+  for (std::size_t bin = 0; bin < sums.size(); bin++) {
+    file << (bin > 0 ? ", " : "") << static_cast<std::int64_t>(sums[bin]);
+  }
+  file << "]}";
+}
+
+// Sums of the samples, the speeds and the residence times
+ParticleStatistics::RunningMeans::RunningMeans():
+  Statistic(3) {}
+
+std::string ParticleStatistics::RunningMeans::getName() const { return "means"; }
+
+void ParticleStatistics::RunningMeans::sample(const Sample& sample) {
+  sums_[0] += sample.speeds.size();
+  sums_[1] += std::accumulate(sample.speeds.begin(), sample.speeds.end(), 0.0);
+  sums_[2] += std::accumulate(sample.residenceTimes.begin(), sample.residenceTimes.end(), 0.0);
+}
+
+void ParticleStatistics::RunningMeans::write(std::ostream& file, const std::vector<double>& sums) const {
+  const double samples = std::max(sums[0], 1.0);
+  file << "{\"samples\": " << static_cast<std::int64_t>(sums[0]) << ", \"speed\": " << sums[1] / samples
+       << ", \"residenceTime\": " << sums[2] / samples << "}";
+}
+
+ParticleStatistics::WallHits::WallHits():
+  Statistic(NUMBER_OF_REGIONS) {}
+
+std::string ParticleStatistics::WallHits::getName() const { return "hits"; }
+
+void ParticleStatistics::WallHits::sample(const Sample& sample) {
+  for (int region = 0; region < NUMBER_OF_REGIONS; region++) {
+    sums_[region] += sample.hits[region];
+  }
+}
+
+void ParticleStatistics::WallHits::write(std::ostream& file, const std::vector<double>& sums) const {
+  static constexpr const char* names[NUMBER_OF_REGIONS] = {
+    "left", "right", "bottom", "top", "front", "back", "obstacles"};
+  file << "{";
+  for (int region = 0; region < NUMBER_OF_REGIONS; region++) {
+    file << (region > 0 ? ", " : "") << "\"" << names[region] << "\": " << static_cast<std::int64_t>(sums[region]);
+  }
+  file << "}";
+}
+
+ParticleStatistics::Statistics ParticleStatistics::create(const ParticleParameters& parameters) {
+  Statistics statistics;
+
+  std::stringstream list(parameters.statistics);
+  std::string       name;
+  while (std::getline(list, name, ',')) {
+    name.erase(0, name.find_first_not_of(" \t"));
+    name.erase(name.find_last_not_of(" \t") + 1);
+    if (name == "residence") {
+      statistics.push_back(
+        std::make_unique<ResidenceTimeHistogram>(parameters.residenceBinWidth, parameters.residenceBins)
+      );
+    } else if (name == "means") {
+      statistics.push_back(std::make_unique<RunningMeans>());
+    } else if (name == "hits") {
+      statistics.push_back(std::make_unique<WallHits>());
+    } else if (!name.empty()) {
+      throw std::runtime_error("Unknown particle statistic " + name + "! Currently supported: residence, means, hits");
+    }
+  }
+
+  return statistics;
+}
+
+std::string ParticleStatistics::getFileName(const std::string& prefix, int timeSteps) {
+  return "Output/" + prefix + "/" + prefix + "statistics." + std::to_string(timeSteps) + ".json";
+}
+
+void ParticleStatistics::write(
+  std::ostream& file, const Statistics& statistics, const std::vector<double>& sums, int timeSteps, RealType time
+) {
+  file << std::setprecision(std::numeric_limits<double>::max_digits10);
+  file << "{\"timeStep\": " << timeSteps << ", \"time\": " << time;
+
+  auto first = sums.begin();
+  for (const auto& statistic : statistics) {
+    const auto last = first + statistic->getSums().size();
+    file << ", \"" << statistic->getName() << "\": ";
+    statistic->write(file, std::vector<double>(first, last));
+    first = last;
+  }
+  file << "}" << std::endl;
+}
+
+void ParticleStatistics::reduce(
+  const Statistics& statistics, const std::string& prefix, int rank, int timeSteps, RealType time
+) {
+  if (statistics.empty()) {
+    return;
+  }
+
+  std::vector<double> localSums;
+  for (const auto& statistic : statistics) {
+    localSums.insert(localSums.end(), statistic->getSums().begin(), statistic->getSums().end());
+  }
+  std::vector<double> sums(localSums.size());
+  MPI_Reduce(localSums.data(), sums.data(), localSums.size(), MPI_DOUBLE, MPI_SUM, 0, PETSC_COMM_WORLD);
+
+  if (rank == 0) {
+    std::ofstream file(getFileName(prefix, timeSteps));
+    write(file, statistics, sums, timeSteps, time);
+  }
+}
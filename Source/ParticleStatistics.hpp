@@ -0,0 +1,103 @@
+#pragma once
+
+#include "StdAfx.hpp"
+
+#include "Parameters.hpp"
+
+/** In-situ statistics of the tracer particles
+ *
+ * Every statistic accumulates sums over the particles of a subdomain while the simulation runs. At output intervals,
+ * the sums of all ranks are reduced onto rank 0, which writes the statistics of the time step as one JSON file. The
+ * statistics are cumulative since the start of the run.
+ */
+namespace ParticleStatistics {
+
+  //! Walls of the domain and the obstacles, whose hits by particles are counted
+  enum Region { LEFT, RIGHT, BOTTOM, TOP, FRONT, BACK, OBSTACLES, NUMBER_OF_REGIONS };
+
+  /** Particles of a subdomain after an advection */
+  struct Sample {
+    const std::vector<RealType>&                       speeds;         //! Speed of every particle
+    const std::vector<RealType>&                       residenceTimes; //! Time since the injection of every particle
+    const std::array<std::int64_t, NUMBER_OF_REGIONS>& hits;           //! Wall and obstacle hits during the advection
+  };
+
+  /** A streaming quantity, kept as sums which add up over the ranks */
+  class Statistic {
+  protected:
+    std::vector<double> sums_;
+
+  public:
+    explicit Statistic(std::size_t numberOfSums);
+    virtual ~Statistic() = default;
+
+    /** Key of the statistic in the output */
+    virtual std::string getName() const = 0;
+
+    /** Accumulates the particles of the subdomain after an advection */
+    virtual void sample(const Sample& sample);
+
+    /** Accumulates a particle which left the domain */
+    virtual void exit(RealType residenceTime);
+
+    /** Writes the statistic as a JSON value, given the sums of all ranks */
+    virtual void write(std::ostream& file, const std::vector<double>& sums) const = 0;
+
+    std::vector<double>& getSums();
+  };
+
+  /** Histogram of the residence times of the particles which left the domain, with the last bin open-ended */
+  class ResidenceTimeHistogram: public Statistic {
+  private:
+    RealType binWidth_;
+
+  public:
+    ResidenceTimeHistogram(RealType binWidth, int bins);
+
+    std::string getName() const override;
+    void        exit(RealType residenceTime) override;
+    void        write(std::ostream& file, const std::vector<double>& sums) const override;
+  };
+
+  /** Running means of the speed and the residence time of the particles in the domain, over all samples */
+  class RunningMeans: public Statistic {
+  public:
+    RunningMeans();
+
+    std::string getName() const override;
+    void        sample(const Sample& sample) override;
+    void        write(std::ostream& file, const std::vector<double>& sums) const override;
+  };
+
+  /** Counters of the hits of each wall and of the obstacles */
+  class WallHits: public Statistic {
+  public:
+    WallHits();
+
+    std::string getName() const override;
+    void        sample(const Sample& sample) override;
+    void        write(std::ostream& file, const std::vector<double>& sums) const override;
+  };
+
+  using Statistics = std::vector<std::unique_ptr<Statistic>>;
+
+  /** Creates the statistics named in the comma-separated list of the parameters: residence, means, hits */
+  Statistics create(const ParticleParameters& parameters);
+
+  /** Name of the statistics file of a time step, in the output folder of the given VTK prefix */
+  std::string getFileName(const std::string& prefix, int timeSteps);
+
+  /** Writes the statistics of a time step as one JSON object
+   *
+   * @param sums Sums of all ranks, of all statistics one after the other
+   */
+  void write(
+    std::ostream& file, const Statistics& statistics, const std::vector<double>& sums, int timeSteps, RealType time
+  );
+
+  /** Reduces the sums of all ranks onto rank 0, which writes them to the statistics file of the time step. Has to be
+   * called by all processes.
+   */
+  void reduce(const Statistics& statistics, const std::string& prefix, int rank, int timeSteps, RealType time);
+
+} // namespace ParticleStatistics
@@ -0,0 +1,70 @@
+#include "StdAfx.hpp"
+
+#include "ParticleTrajectory.hpp"
+
+std::string ParticleTrajectory::getFileName(const std::string& prefix, int rank) {
+  return "Output/" + prefix + "/" + prefix + "trajectories." + std::to_string(rank) + ".bin";
+}
+
+void ParticleTrajectory::writeHeader(std::ostream& file, int dim) {
+  Header header;
+  std::copy(std::begin(MAGIC), std::end(MAGIC), header.magic);
+  header.version = VERSION;
+  header.dim     = dim;
+  file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+}
+
+void ParticleTrajectory::truncate(const std::string& fileName, double time) {
+  std::ifstream file(fileName, std::ios::binary);
+  if (!file) {
+    return;
+  }
+
+  Header header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(Header))
+      || !std::equal(std::begin(MAGIC), std::end(MAGIC), header.magic) || header.version != VERSION) {
+    throw std::runtime_error(fileName + " is not a particle trajectory log");
+  }
+
+  // A record cut off at the end is removed as well
+  std::uintmax_t size = sizeof(Header);
+  Record         record;
+  while (file.read(reinterpret_cast<char*>(&record), sizeof(Record)) && record.time < time) {
+    size += sizeof(Record);
+  }
+  file.close();
+  std::filesystem::resize_file(fileName, size);
+}
+
+std::map<std::int64_t, ParticleTrajectory::Pathline> ParticleTrajectory::readPathlines(
+  const std::vector<std::string>& fileNames
+) {
+  std::map<std::int64_t, Pathline> pathlines;
+
+  for (const std::string& fileName : fileNames) {
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file) {
+      throw std::runtime_error("Cannot open the particle trajectory log " + fileName);
+    }
+
+    Header header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(Header))
+        || !std::equal(std::begin(MAGIC), std::end(MAGIC), header.magic) || header.version != VERSION) {
+      throw std::runtime_error(fileName + " is not a particle trajectory log");
+    }
+
+    // A record cut off at the end stems from a run which was aborted while writing, and is skipped
+    Record record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(Record))) {
+      pathlines[record.id].push_back(record);
+    }
+  }
+
+  for (auto& [id, pathline] : pathlines) {
+    std::stable_sort(pathline.begin(), pathline.end(), [](const Record& a, const Record& b) {
+      return a.time < b.time;
+    });
+  }
+
+  return pathlines;
+}
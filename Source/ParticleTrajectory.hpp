@@ -0,0 +1,56 @@
+#pragma once
+
+#include "StdAfx.hpp"
+
+/** Binary trajectory logs of the tracer particles
+ *
+ * Every rank appends the particles it owns at every trajectoryStride-th time step to its own log, named by
+ * getFileName(). A log starts with a Header, written by writeHeader(), followed by Records in the order they were
+ * written. The records of 2D simulations have a zero third component. Logs are written in the byte order of the
+ * machine, readPathlines() reads them back.
+ */
+namespace ParticleTrajectory {
+
+  constexpr char         MAGIC[8] = {'N', 'S', 'E', 'O', 'F', 'T', 'R', 'J'};
+  constexpr std::int32_t VERSION  = 1;
+
+  struct Header {
+    char         magic[8];
+    std::int32_t version;
+    std::int32_t dim; //! Dimension of the simulation which wrote the log
+  };
+
+  struct Record {
+    std::int64_t id; //! Identifier of the particle
+    double       time;
+    double       position[3];
+    double       velocity[3];
+  };
+
+  /** Records of one particle, ordered by time */
+  using Pathline = std::vector<Record>;
+
+  /** Name of the log of a rank, in the output folder of the given VTK prefix */
+  std::string getFileName(const std::string& prefix, int rank);
+
+  /** Writes the header of a new log */
+  void writeHeader(std::ostream& file, int dim);
+
+  /** Cuts a log off before its first record at or after the given time
+   *
+   * A run which restarts from a checkpoint removes the records written after the checkpoint, before it appends its own.
+   * Records are appended in the order of time, so the records before the cut are kept. Does nothing if the log does
+   * not exist.
+   */
+  void truncate(const std::string& fileName, double time);
+
+  /** Reads the logs of all ranks and stitches the records of every particle into its pathline
+   *
+   * A particle which migrated between subdomains is found in the logs of several ranks, one after the other.
+   *
+   * @param fileNames Logs to be read, usually the ones of all ranks of a run
+   * @return Pathlines by particle identifier
+   */
+  std::map<std::int64_t, Pathline> readPathlines(const std::vector<std::string>& fileNames);
+
+} // namespace ParticleTrajectory
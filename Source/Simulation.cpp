@@ -13,15 +13,13 @@ Simulation::Simulation(Parameters& parameters, FlowField& flowField):
   maxUBoundaryIterator_(flowField_, parameters, maxUStencil_),
   globalBoundaryFactory_(parameters),
   wallVelocityIterator_(globalBoundaryFactory_.getGlobalBoundaryVelocityIterator(flowField_)),
-  wallFGHIterator_(globalBoundaryFactory_.getGlobalBoundaryFGHIterator(flowField_)),
   fghStencil_(parameters),
-  fghIterator_(flowField_, parameters, fghStencil_),
+  rhsStencil_(parameters),
+  fghRhsIterator_(flowField_, parameters, fghStencil_, rhsStencil_, globalBoundaryFactory_),
   velocityStencil_(parameters),
   obstacleStencil_(parameters),
-  velocityIterator_(flowField_, parameters, velocityStencil_),
-  obstacleIterator_(flowField_, parameters, obstacleStencil_),
-  rhsStencil_(parameters),
-  rhsIterator_(flowField_, parameters, rhsStencil_),
+  velocityUpdateIterator_(flowField_, parameters, velocityStencil_, obstacleStencil_, maxUStencil_),
+  velocityReduced_(false),
   petscParallelManager_(parameters, flowField_),
 #ifdef ENABLE_PETSC
   solver_(std::make_unique<Solvers::PetscSolver>(flowField_, parameters))
@@ -74,12 +72,8 @@ void Simulation::initializeFlowField() {
 void Simulation::solveTimestep() {
   // Determine and set max. timestep which is allowed in this simulation
   setTimeStep();
-  // Compute FGH
-  fghIterator_.iterate();
-  // Set global boundary values
-  wallFGHIterator_.iterate();
-  // Compute the right hand side (RHS)
-  rhsIterator_.iterate();
+  // Compute FGH, set its global boundary values and compute the right hand side (RHS)
+  fghRhsIterator_.iterate();
   // Solve for pressure
   solver_->solve();
 
@@ -93,9 +87,10 @@ void Simulation::solveTimestep() {
     petscParallelManager_.communicatePressure();
   }
 
-  // Compute velocity
-  velocityIterator_.iterate();
-  obstacleIterator_.iterate();
+  // Compute velocity and the maximum velocity of its inner cells
+  maxUStencil_.reset();
+  velocityUpdateIterator_.iterate();
+  velocityReduced_ = true;
 
   // TODO WS2: communicate velocity values
   for (int i = 0; i < parameters_.geometry.dim; i++) {
@@ -111,6 +106,14 @@ void Simulation::solveTimestep() {
   wallVelocityIterator_.iterate();
 }
 
+void Simulation::communicateFlowField() {
+  for (int i = 0; i < parameters_.geometry.dim; i++) {
+    petscParallelManager_.communicatePressure();
+    petscParallelManager_.communicateVelocities();
+  }
+  wallVelocityIterator_.iterate();
+}
+
 void Simulation::plotVTK(int timeStep, RealType simulationTime) {
 #ifndef DISABLE_OUTPUT
   Stencils::VTKStencil     vtkStencil(parameters_);
@@ -128,8 +131,12 @@ void Simulation::setTimeStep() {
                     + 1.0 / (parameters_.meshsize->getDyMin() * parameters_.meshsize->getDyMin());
 
   // Determine maximum velocity
-  maxUStencil_.reset();
-  maxUFieldIterator_.iterate();
+  if (velocityReduced_) {
+    velocityUpdateIterator_.reduceOuterLayers();
+  } else {
+    maxUStencil_.reset();
+    maxUFieldIterator_.iterate();
+  }
   maxUBoundaryIterator_.iterate();
   if (parameters_.geometry.dim == 3) {
     factor += 1.0 / (parameters_.meshsize->getDzMin() * parameters_.meshsize->getDzMin());
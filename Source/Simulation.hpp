@@ -1,9 +1,11 @@
 #pragma once
 
 #include "Definitions.hpp"
+#include "FGHRHSIterator.hpp"
 #include "FlowField.hpp"
 #include "GlobalBoundaryFactory.hpp"
 #include "Iterators.hpp"
+#include "VelocityUpdateIterator.hpp"
 
 #include "ParallelManagers/PetscParallelManager.hpp"
 #include "Solvers/LinearSolver.hpp"
@@ -26,25 +28,25 @@ protected:
 
   FlowField& flowField_;
 
-  Stencils::MaxUStencil             maxUStencil_;
-  FieldIterator<FlowField>          maxUFieldIterator_;
-  GlobalBoundaryIterator<FlowField> maxUBoundaryIterator_;
+  Stencils::MaxUStencil                                  maxUStencil_;
+  StencilFieldIterator<FlowField, Stencils::MaxUStencil> maxUFieldIterator_;
+  GlobalBoundaryIterator<FlowField>                      maxUBoundaryIterator_;
 
   // Set up the boundary conditions
   GlobalBoundaryFactory             globalBoundaryFactory_;
   GlobalBoundaryIterator<FlowField> wallVelocityIterator_;
-  GlobalBoundaryIterator<FlowField> wallFGHIterator_;
 
-  Stencils::FGHStencil     fghStencil_;
-  FieldIterator<FlowField> fghIterator_;
+  // FGH, its wall values and the RHS are computed in one sweep
+  Stencils::FGHStencil                 fghStencil_;
+  Stencils::RHSStencil                 rhsStencil_;
+  FGHRHSIterator<Stencils::FGHStencil> fghRhsIterator_;
 
-  Stencils::VelocityStencil velocityStencil_;
-  Stencils::ObstacleStencil obstacleStencil_;
-  FieldIterator<FlowField>  velocityIterator_;
-  FieldIterator<FlowField>  obstacleIterator_;
+  // The velocity update, the obstacle cells and the maximum velocity of the next time step are computed in one sweep
+  Stencils::VelocityStencil                     velocityStencil_;
+  Stencils::ObstacleStencil                     obstacleStencil_;
+  VelocityUpdateIterator<Stencils::MaxUStencil> velocityUpdateIterator_;
 
-  Stencils::RHSStencil     rhsStencil_;
-  FieldIterator<FlowField> rhsIterator_;
+  bool velocityReduced_; //! Whether the velocity update has reduced the inner cells for the next time step
 
   ParallelManagers::PetscParallelManager petscParallelManager_;
 
@@ -61,6 +63,11 @@ public:
 
   virtual void solveTimestep();
 
+  /** Fills the ghost layers and the global boundaries of the pressure and the velocity from the cells of the
+   * subdomains, e.g. after the flow field was redistributed among them
+   */
+  void communicateFlowField();
+
   /** Plots the flow field */
   virtual void plotVTK(int timeStep, RealType simulationTime);
 };
\ No newline at end of file
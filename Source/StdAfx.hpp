@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <array>
 #include <assert.h>
+#include <bit>
 #include <bitset>
 #include <chrono>
 #include <cmath>
@@ -67,6 +68,10 @@
 #include <unistd.h>
 #endif
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef ENABLE_PETSC
 #include <petscdm.h>
 #include <petscdmda.h>
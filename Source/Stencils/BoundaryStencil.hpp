@@ -17,6 +17,11 @@ namespace Stencils {
 
     virtual ~BoundaryStencil() = default;
 
+    /** Whether the wall operations may be applied to different cells of a wall concurrently. Stencils which
+     * accumulate over the cells return false, so that the GlobalBoundaryIterator applies them sequentially.
+     */
+    virtual bool isThreadSafe() const { return true; }
+
     /** Represents an operation in the left wall of a 2D domain.
      *
      * @param flowField State of the flow field
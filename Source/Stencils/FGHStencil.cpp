@@ -3,6 +3,7 @@
 #include "FGHStencil.hpp"
 
 #include "Definitions.hpp"
+#include "FGHRHSIterator.hpp"
 #include "StencilFunctions.hpp"
 
 Stencils::FGHStencil::FGHStencil(const Parameters& parameters):
@@ -41,3 +42,6 @@ void Stencils::FGHStencil::apply(FlowField& flowField, int i, int j, int k) {
     }
   }
 }
+
+template class StencilFieldIterator<FlowField, Stencils::FGHStencil>;
+template class FGHRHSIterator<Stencils::FGHStencil>;
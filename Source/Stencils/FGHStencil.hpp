@@ -2,6 +2,7 @@
 
 #include "FieldStencil.hpp"
 #include "FlowField.hpp"
+#include "Iterators.hpp"
 #include "Parameters.hpp"
 
 namespace Stencils {
@@ -21,3 +22,6 @@ namespace Stencils {
     void apply(FlowField& flowField, int i, int j, int k) override;
   };
 } // namespace Stencils
+
+// Instantiated in FGHStencil.cpp
+extern template class StencilFieldIterator<FlowField, Stencils::FGHStencil>;
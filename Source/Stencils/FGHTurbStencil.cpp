@@ -3,6 +3,7 @@
 #include "FGHTurbStencil.hpp"
 
 #include "Definitions.hpp"
+#include "FGHRHSIterator.hpp"
 #include "StencilFunctions.hpp"
 
 Stencils::FGHTurbStencil::FGHTurbStencil(const Parameters& parameters):
@@ -43,3 +44,6 @@ void Stencils::FGHTurbStencil::apply(FlowField& flowField, int i, int j, int k)
     }
   }
 }
+
+template class StencilFieldIterator<FlowField, Stencils::FGHTurbStencil>;
+template class FGHRHSIterator<Stencils::FGHTurbStencil>;
@@ -2,6 +2,7 @@
 
 #include "FieldStencil.hpp"
 #include "FlowField.hpp"
+#include "Iterators.hpp"
 #include "Parameters.hpp"
 
 namespace Stencils {
@@ -21,4 +22,7 @@ namespace Stencils {
     void apply(FlowField& flowField, int i, int j) override;
     void apply(FlowField& flowField, int i, int j, int k) override;
   };
-} // namespace Stencils
\ No newline at end of file
+} // namespace Stencils
+
+// Instantiated in FGHTurbStencil.cpp
+extern template class StencilFieldIterator<FlowField, Stencils::FGHTurbStencil>;
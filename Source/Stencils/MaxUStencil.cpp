@@ -2,6 +2,8 @@
 
 #include "MaxUStencil.hpp"
 
+#include "VelocityUpdateIterator.hpp"
+
 Stencils::MaxUStencil::MaxUStencil(const Parameters& parameters):
   FieldStencil<FlowField>(parameters),
   BoundaryStencil<FlowField>(parameters) {
@@ -73,10 +75,21 @@ void Stencils::MaxUStencil::cellMaxValue(FlowField& flowField, int i, int j, int
   }
 }
 
+bool Stencils::MaxUStencil::isThreadSafe() const { return false; }
+
 void Stencils::MaxUStencil::reset() {
   maxValues_[0] = 0;
   maxValues_[1] = 0;
   maxValues_[2] = 0;
 }
 
+void Stencils::MaxUStencil::reduce(const MaxUStencil& other) {
+  for (int d = 0; d < 3; d++) {
+    maxValues_[d] = std::max(maxValues_[d], other.maxValues_[d]);
+  }
+}
+
 const RealType* Stencils::MaxUStencil::getMaxValues() const { return maxValues_; }
+
+template class StencilFieldIterator<FlowField, Stencils::MaxUStencil>;
+template class VelocityUpdateIterator<Stencils::MaxUStencil>;
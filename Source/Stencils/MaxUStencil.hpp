@@ -3,6 +3,7 @@
 #include "BoundaryStencil.hpp"
 #include "FieldStencil.hpp"
 #include "FlowField.hpp"
+#include "Iterators.hpp"
 #include "Parameters.hpp"
 
 namespace Stencils {
@@ -56,10 +57,16 @@ namespace Stencils {
     void applyFrontWall(FlowField& flowField, int i, int j, int k) override;
     void applyBackWall(FlowField& flowField, int i, int j, int k) override;
 
+    bool isThreadSafe() const override;
+
     /** Resets the maximum values to zero before computing the timestep.
      */
     void reset();
 
+    /** Merges the maximum values of the copy of the stencil applied by another thread.
+     */
+    void reduce(const MaxUStencil& other);
+
     /** Returns the array with the maximum modules of the components of the velocity,
      *  divided by the respective local meshsize.
      */
@@ -67,3 +74,6 @@ namespace Stencils {
   };
 
 } // namespace Stencils
+
+// Instantiated in MaxUStencil.cpp
+extern template class StencilFieldIterator<FlowField, Stencils::MaxUStencil>;
@@ -108,3 +108,5 @@ void Stencils::ObstacleStencil::apply(FlowField& flowField, int i, int j, int k)
     }
   }
 }
+
+template class StencilFieldIterator<FlowField, Stencils::ObstacleStencil>;
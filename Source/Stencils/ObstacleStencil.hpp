@@ -2,6 +2,7 @@
 
 #include "FieldStencil.hpp"
 #include "FlowField.hpp"
+#include "Iterators.hpp"
 #include "Parameters.hpp"
 
 namespace Stencils {
@@ -18,3 +19,6 @@ namespace Stencils {
   };
 
 } // namespace Stencils
+
+// Instantiated in ObstacleStencil.cpp
+extern template class StencilFieldIterator<FlowField, Stencils::ObstacleStencil>;
@@ -24,4 +24,6 @@ void Stencils::RHSStencil::apply(FlowField& flowField, int i, int j, int k) {
   RealType dhdz = (FGH.getVector(i, j, k)[2] - FGH.getVector(i, j, k - 1)[2]) / parameters_.meshsize->getDz(i, j, k);
 
   flowField.getRHS().getScalar(i, j, k) = (dfdx + dgdy + dhdz) / parameters_.timestep.dt;
-}
\ No newline at end of file
+}
+
+template class StencilFieldIterator<FlowField, Stencils::RHSStencil>;
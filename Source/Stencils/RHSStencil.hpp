@@ -2,6 +2,7 @@
 
 #include "FieldStencil.hpp"
 #include "FlowField.hpp"
+#include "Iterators.hpp"
 #include "Parameters.hpp"
 
 namespace Stencils {
@@ -17,3 +18,6 @@ namespace Stencils {
     void apply(FlowField& flowField, int i, int j, int k) override;
   };
 } // namespace Stencils
+
+// Instantiated in RHSStencil.cpp
+extern template class StencilFieldIterator<FlowField, Stencils::RHSStencil>;
@@ -2,6 +2,8 @@
 
 #include "TimeStepStencil.hpp"
 
+#include "VelocityUpdateIterator.hpp"
+
 Stencils::TimeStepStencil::TimeStepStencil(const Parameters& parameters):
   FieldStencil<FlowField>(parameters) {}
 
@@ -79,4 +81,9 @@ void Stencils::TimeStepStencil::apply(FlowField& flowField, int i, int j, int k)
 
   if (cell_dt < dt)
     dt = cell_dt;
-}
\ No newline at end of file
+}
+
+void Stencils::TimeStepStencil::reduce(const TimeStepStencil& other) { dt = std::min(dt, other.dt); }
+
+template class StencilFieldIterator<FlowField, Stencils::TimeStepStencil>;
+template class VelocityUpdateIterator<Stencils::TimeStepStencil>;
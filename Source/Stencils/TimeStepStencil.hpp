@@ -2,6 +2,7 @@
 
 #include "FieldStencil.hpp"
 #include "FlowField.hpp"
+#include "Iterators.hpp"
 #include "Parameters.hpp"
 
 namespace Stencils {
@@ -18,5 +19,11 @@ namespace Stencils {
 
     void apply(FlowField& flowField, int i, int j) override;
     void apply(FlowField& flowField, int i, int j, int k) override;
+
+    /** Keeps the smaller time step of this stencil and of the copy applied by another thread */
+    void reduce(const TimeStepStencil& other);
   };
 } // namespace Stencils
+
+// Instantiated in TimeStepStencil.cpp
+extern template class StencilFieldIterator<FlowField, Stencils::TimeStepStencil>;
@@ -5,6 +5,7 @@
 Stencils::VTKStencil::VTKStencil(const Parameters& parameters):
   FieldStencil<FlowField>(parameters),
   written_(false),
+  writeConcentration_(parameters.particles.enable && !parameters.particles.deposit.empty()),
   prefix_(parameters.vtk.prefix) {
 
   if (parameters_.parallel.rank == 0) {
@@ -105,6 +106,10 @@ void Stencils::VTKStencil::apply(FlowField& flowField, int i, int j) {
     pressureStream_ << "0.0" << std::endl;
     velocityStream_ << "0.0 0.0 0.0" << std::endl;
   }
+
+  if (writeConcentration_) {
+    concentrationStream_ << flowField.getConcentration().getScalar(i, j) << std::endl;
+  }
 }
 
 void Stencils::VTKStencil::apply(FlowField& flowField, int i, int j, int k) {
@@ -122,6 +127,10 @@ void Stencils::VTKStencil::apply(FlowField& flowField, int i, int j, int k) {
     pressureStream_ << "0.0" << std::endl;
     velocityStream_ << "0.0 0.0 0.0" << std::endl;
   }
+
+  if (writeConcentration_) {
+    concentrationStream_ << flowField.getConcentration().getScalar(i, j, k) << std::endl;
+  }
 }
 
 void Stencils::VTKStencil::openFile(int timeStep, RealType simulationTime) {
@@ -173,6 +182,13 @@ void Stencils::VTKStencil::write(FlowField& flowField, int timeStep, RealType si
     velocityStream_.str("");
   }
 
+  // The particle concentration is one more array of the cell data
+  if (writeConcentration_) {
+    ofile_ << "SCALARS concentration float 1" << std::endl << "LOOKUP_TABLE default" << std::endl;
+    ofile_ << concentrationStream_.str() << std::endl;
+    concentrationStream_.str("");
+  }
+
   written_ = true;
   closeFile();
 }
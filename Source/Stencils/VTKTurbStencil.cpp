@@ -5,6 +5,7 @@
 Stencils::VTKTurbStencil::VTKTurbStencil(const Parameters& parameters):
   FieldStencil<FlowField>(parameters),
   written_(false),
+  writeConcentration_(parameters.particles.enable && !parameters.particles.deposit.empty()),
   prefix_(parameters.vtk.prefix) {
 
   if (parameters_.parallel.rank == 0) {
@@ -113,6 +114,10 @@ void Stencils::VTKTurbStencil::apply(FlowField& flowField, int i, int j) {
     hStream_ << "0.0" << std::endl;
 #endif
   }
+
+  if (writeConcentration_) {
+    concentrationStream_ << flowField.getConcentration().getScalar(i, j) << std::endl;
+  }
 }
 
 void Stencils::VTKTurbStencil::apply(FlowField& flowField, int i, int j, int k) {
@@ -138,6 +143,10 @@ void Stencils::VTKTurbStencil::apply(FlowField& flowField, int i, int j, int k)
     hStream_ << "0.0" << std::endl;
 #endif
   }
+
+  if (writeConcentration_) {
+    concentrationStream_ << flowField.getConcentration().getScalar(i, j, k) << std::endl;
+  }
 }
 
 void Stencils::VTKTurbStencil::openFile(int timeStep, RealType simulationTime) {
@@ -212,6 +221,13 @@ void Stencils::VTKTurbStencil::write(FlowField& flowField, int timeStep, RealTyp
 #endif
   }
 
+  // The particle concentration is one more array of the cell data
+  if (writeConcentration_) {
+    ofile_ << "SCALARS concentration float 1" << std::endl << "LOOKUP_TABLE default" << std::endl;
+    ofile_ << concentrationStream_.str() << std::endl;
+    concentrationStream_.str("");
+  }
+
   written_ = true;
   closeFile();
 }
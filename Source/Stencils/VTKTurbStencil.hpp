@@ -13,9 +13,10 @@ namespace Stencils {
    */
   class VTKTurbStencil: public FieldStencil<FlowField> {
   private:
-    bool          written_; //! Whether the file has already been written
-    std::string   prefix_;  //! Prefix to be attached to the vtk files
-    std::ofstream ofile_;   //! Output file stream
+    bool          written_;            //! Whether the file has already been written
+    bool          writeConcentration_; //! Whether the particle concentration is written as well
+    std::string   prefix_;             //! Prefix to be attached to the vtk files
+    std::ofstream ofile_;              //! Output file stream
 
     std::stringstream pressureStream_;           //! Stream for the pressure data
     std::stringstream velocityStream_;           //! Stream for the velocity data
@@ -23,6 +24,9 @@ namespace Stencils {
 #ifndef NDEBUG
     std::stringstream hStream_;                  //! Stream for the wall distance (h)  data
 #endif
+
+    std::stringstream concentrationStream_; //! Stream for the particle concentration data
+
     void writeVTKHeader(std::ostream& file) const;
     void writePoints(std::ostream& file, RealType simulationTime) const;
 
@@ -67,3 +67,5 @@ void Stencils::VelocityStencil::apply(FlowField& flowField, int i, int j, int k)
     }
   }
 }
+
+template class StencilFieldIterator<FlowField, Stencils::VelocityStencil>;
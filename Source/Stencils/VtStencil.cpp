@@ -35,3 +35,5 @@ void Stencils::VtStencil::apply(FlowField& flowField, int i, int j, int k) {
 
   vt = lm * lm * sqrt(2* (S11 * S11 + S22 * S22 + S33 * S33 + 2 * (S12 * S12 + S13 * S13 + S23 * S23)));
 }
+
+template class StencilFieldIterator<FlowField, Stencils::VtStencil>;
@@ -3,6 +3,7 @@
 #include "Definitions.hpp"
 #include "FieldStencil.hpp"
 #include "FlowField.hpp"
+#include "Iterators.hpp"
 
 namespace Stencils {
 
@@ -21,4 +22,7 @@ namespace Stencils {
     void apply(FlowField& flowField, int i, int j, int k) override;
   };
 
-} // namespace Stencils
\ No newline at end of file
+} // namespace Stencils
+
+// Instantiated in VtStencil.cpp
+extern template class StencilFieldIterator<FlowField, Stencils::VtStencil>;
@@ -8,9 +8,10 @@
 TurbulentSimulation::TurbulentSimulation(Parameters& parameters, FlowField& flowField):
   Simulation(parameters, flowField),
   fghTurbStencil_(parameters),
-  fghTurbIterator_(flowField_, parameters, fghTurbStencil_),
+  fghTurbRhsIterator_(flowField_, parameters, fghTurbStencil_, rhsStencil_, globalBoundaryFactory_),
   timeStepStencil_(parameters),
   timeStepIterator_(flowField_, parameters, timeStepStencil_),
+  velocityUpdateTurbIterator_(flowField_, parameters, velocityStencil_, obstacleStencil_, timeStepStencil_),
   vtStencil_(parameters),
   vtIterator_(flowField_, parameters, vtStencil_) {}
 
@@ -81,12 +82,8 @@ void TurbulentSimulation::solveTimestep() {
     petscParallelManager_.communicateVt();
   }
 
-  // Compute FGH
-  fghTurbIterator_.iterate();
-  // Set global boundary values
-  wallFGHIterator_.iterate();
-  // Compute the right hand side (RHS)
-  rhsIterator_.iterate();
+  // Compute FGH, set its global boundary values and compute the right hand side (RHS)
+  fghTurbRhsIterator_.iterate();
 
   // Solve for pressure
   solver_->solve();
@@ -100,9 +97,9 @@ void TurbulentSimulation::solveTimestep() {
     petscParallelManager_.communicatePressure();
   }
 
-  // Compute velocity
-  velocityIterator_.iterate();
-  obstacleIterator_.iterate();
+  // Compute velocity and the time step of its inner cells
+  velocityUpdateTurbIterator_.iterate();
+  velocityReduced_ = true;
   // TODO WS2: communicate velocity values
   for (int i = 0; i < parameters_.geometry.dim; i++) {
     /*
@@ -127,7 +124,11 @@ void TurbulentSimulation::plotVTK(int timeStep, RealType simulationTime) {
 
 void TurbulentSimulation::setTimeStep() {
   ASSERTION(parameters_.geometry.dim == 2 || parameters_.geometry.dim == 3);
-  timeStepIterator_.iterate();
+  if (velocityReduced_) {
+    velocityUpdateTurbIterator_.reduceOuterLayers();
+  } else {
+    timeStepIterator_.iterate();
+  }
 
   RealType localMin, globalMin;
   localMin = timeStepStencil_.dt;
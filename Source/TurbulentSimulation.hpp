@@ -27,14 +27,15 @@
 
 class TurbulentSimulation: public Simulation {
 protected:
-  Stencils::FGHTurbStencil fghTurbStencil_;
-  FieldIterator<FlowField> fghTurbIterator_;
+  Stencils::FGHTurbStencil                 fghTurbStencil_;
+  FGHRHSIterator<Stencils::FGHTurbStencil> fghTurbRhsIterator_;
 
-  Stencils::TimeStepStencil timeStepStencil_;
-  FieldIterator<FlowField>  timeStepIterator_;
+  Stencils::TimeStepStencil                                  timeStepStencil_;
+  StencilFieldIterator<FlowField, Stencils::TimeStepStencil> timeStepIterator_;
+  VelocityUpdateIterator<Stencils::TimeStepStencil>          velocityUpdateTurbIterator_;
 
-  Stencils::VtStencil      vtStencil_;
-  FieldIterator<FlowField> vtIterator_;
+  Stencils::VtStencil                                  vtStencil_;
+  StencilFieldIterator<FlowField, Stencils::VtStencil> vtIterator_;
 
 public:
   TurbulentSimulation(Parameters& parameters, FlowField& flowField);
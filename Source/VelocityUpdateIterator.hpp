@@ -0,0 +1,70 @@
+#pragma once
+
+#include "FlowField.hpp"
+#include "Iterators.hpp"
+#include "Parameters.hpp"
+
+#include "Stencils/MaxUStencil.hpp"
+#include "Stencils/ObstacleStencil.hpp"
+#include "Stencils/TimeStepStencil.hpp"
+#include "Stencils/VelocityStencil.hpp"
+
+/** Updates the velocities after the pressure solve, corrects the obstacle cells and accumulates the time step
+ * criterion of the next time step in one sweep
+ *
+ * Replaces a sweep of the velocity stencil, a sweep of the obstacle stencil and the field sweep of the reduction
+ * stencil (MaxUStencil, or TimeStepStencil for turbulent simulations) at the next time step. The sweep computes the
+ * velocities of a row and reduces the row while it is still in cache. The obstacle stencil only changes obstacle
+ * cells, from the velocities of their fluid neighbours, so it is applied to a list of the obstacle cells once all
+ * tiles are done, and the obstacle cells are reduced after their correction. The flags are fixed once the flow field
+ * is initialised, so the list is collected in the first sweep.
+ *
+ * The sweep only reduces the inner cells which neither the velocity communication nor the walls change afterwards.
+ * reduceOuterLayers() reduces the remaining cells of the field sweep once these are done, so that the reduction
+ * covers the same cells with the same values as a field sweep of the reduction stencil.
+ */
+template <class ReductionStencilType>
+class VelocityUpdateIterator: public Iterator<FlowField> {
+private:
+  static constexpr int TILE_SIZE = 16; //! Rows of a tile in y and z
+
+  Stencils::VelocityStencil& velocityStencil_;
+  Stencils::ObstacleStencil& obstacleStencil_;
+  ReductionStencilType&      reductionStencil_;
+
+  bool                            obstaclesFound_; //! Whether obstacleCells_ has been collected
+  std::vector<std::array<int, 3>> obstacleCells_;  //! Obstacle cells within the sweep
+
+  template <int Dim>
+  void findObstacles();
+
+  template <int Dim>
+  void sweep();
+
+  template <int Dim>
+  void reduceLayers();
+
+public:
+  VelocityUpdateIterator(
+    FlowField&                 flowField,
+    const Parameters&          parameters,
+    Stencils::VelocityStencil& velocityStencil,
+    Stencils::ObstacleStencil& obstacleStencil,
+    ReductionStencilType&      reductionStencil
+  );
+
+  virtual ~VelocityUpdateIterator() override = default;
+
+  virtual void iterate() override;
+
+  /** Reduces the outer two layers of the cells of the sweep. Has to be called after the velocities have been
+   * communicated and the walls have been applied.
+   */
+  void reduceOuterLayers();
+};
+
+#include "VelocityUpdateIterator.cpph"
+
+// Instantiated in MaxUStencil.cpp and TimeStepStencil.cpp
+extern template class VelocityUpdateIterator<Stencils::MaxUStencil>;
+extern template class VelocityUpdateIterator<Stencils::TimeStepStencil>;
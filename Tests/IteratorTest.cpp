@@ -0,0 +1,411 @@
+#include "StdAfx.hpp"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "FGHRHSIterator.hpp"
+#include "FlowField.hpp"
+#include "GlobalBoundaryFactory.hpp"
+#include "Iterators.hpp"
+#include "Meshsize.hpp"
+#include "VelocityUpdateIterator.hpp"
+
+#include "Stencils/BFStepInitStencil.hpp"
+#include "Stencils/FGHStencil.hpp"
+#include "Stencils/MaxUStencil.hpp"
+#include "Stencils/ObstacleStencil.hpp"
+#include "Stencils/RHSStencil.hpp"
+#include "Stencils/TimeStepStencil.hpp"
+#include "Stencils/VelocityStencil.hpp"
+
+// Cavity of unit size on a single rank
+static void setUpCavity(Parameters& parameters, int dim, int cells) {
+  parameters.geometry.dim              = dim;
+  parameters.geometry.sizeX            = cells;
+  parameters.geometry.sizeY            = cells;
+  parameters.geometry.sizeZ            = (dim == 3) ? cells : 1;
+  parameters.geometry.lengthX          = 1.0;
+  parameters.geometry.lengthY          = 1.0;
+  parameters.geometry.lengthZ          = 1.0;
+  parameters.parallel.localSize[0]     = parameters.geometry.sizeX;
+  parameters.parallel.localSize[1]     = parameters.geometry.sizeY;
+  parameters.parallel.localSize[2]     = parameters.geometry.sizeZ;
+  parameters.parallel.firstCorner[0]   = 0;
+  parameters.parallel.firstCorner[1]   = 0;
+  parameters.parallel.firstCorner[2]   = 0;
+  parameters.parallel.rank             = 0;
+  parameters.parallel.numProcessors[0] = 1;
+  parameters.parallel.numProcessors[1] = 1;
+  parameters.parallel.numProcessors[2] = 1;
+  parameters.flow.Re                   = 100.0;
+  parameters.solver.gamma              = 0.5;
+  parameters.timestep.dt               = 0.01;
+  parameters.meshsize                  = new UniformMeshsize(parameters);
+}
+
+// Smooth, non-trivial values in every field which the stencils read
+static void fillFields(FlowField& flowField) {
+  for (int k = 0; k < flowField.getCellsZ(); k++) {
+    for (int j = 0; j < flowField.getCellsY(); j++) {
+      for (int i = 0; i < flowField.getCellsX(); i++) {
+        RealType* velocity = flowField.getVelocity().getVector(i, j, k);
+        RealType* fgh      = flowField.getFGH().getVector(i, j, k);
+        flowField.getPressure().getScalar(i, j, k) = std::cos(0.1 * i) * std::sin(0.2 * j) + 0.05 * k;
+        for (int d = 0; d < 3; d++) {
+          velocity[d] = std::sin(0.3 * i + d) * std::cos(0.2 * j - d) + 0.1 * std::sin(0.1 * k);
+          fgh[d]      = std::cos(0.25 * i - d) * std::sin(0.15 * j + d) + 0.1 * k;
+        }
+      }
+    }
+  }
+}
+
+// Compares all cells of a scalar or a vector field of two flow fields
+template <class FieldType>
+static void requireEqual(FieldType& expected, FieldType& actual, int components) {
+  for (int k = 0; k < expected.getNz(); k++) {
+    for (int j = 0; j < expected.getNy(); j++) {
+      for (int i = 0; i < expected.getNx(); i++) {
+        for (int d = 0; d < components; d++) {
+          if constexpr (std::is_same_v<FieldType, ScalarField>) {
+            REQUIRE(actual.getScalar(i, j, k) == expected.getScalar(i, j, k));
+          } else {
+            REQUIRE(actual.getVector(i, j, k)[d] == expected.getVector(i, j, k)[d]);
+          }
+        }
+      }
+    }
+  }
+}
+
+// Applies the stencil to two copies of the same flow field, once through each iterator
+template <class StencilType>
+static void compareIterators(const Parameters& parameters, FlowField& virtualField, FlowField& typedField) {
+  fillFields(virtualField);
+  fillFields(typedField);
+
+  StencilType                                  virtualStencil(parameters);
+  StencilType                                  typedStencil(parameters);
+  FieldIterator<FlowField>                     virtualIterator(virtualField, parameters, virtualStencil);
+  StencilFieldIterator<FlowField, StencilType> typedIterator(typedField, parameters, typedStencil);
+  virtualIterator.iterate();
+  typedIterator.iterate();
+}
+
+TEST_CASE("Test stencil-typed field iteration", "[single-file]") {
+  // The typed iterators run with all OpenMP threads, the virtual ones sequentially
+  spdlog::info("Testing stencil-typed field iteration");
+
+  for (int dim = 2; dim <= 3; dim++) {
+    // Several tiles in every direction, which the threads share
+    Parameters parameters;
+    setUpCavity(parameters, dim, 40);
+    FlowField virtualField(parameters);
+    FlowField typedField(parameters);
+
+    compareIterators<Stencils::FGHStencil>(parameters, virtualField, typedField);
+    requireEqual(virtualField.getFGH(), typedField.getFGH(), dim);
+
+    compareIterators<Stencils::RHSStencil>(parameters, virtualField, typedField);
+    requireEqual(virtualField.getRHS(), typedField.getRHS(), 1);
+
+    compareIterators<Stencils::VelocityStencil>(parameters, virtualField, typedField);
+    requireEqual(virtualField.getVelocity(), typedField.getVelocity(), dim);
+
+    // The maximum depends on the cells visited, so different bounds would show up in the result
+    fillFields(virtualField);
+    Stencils::MaxUStencil                                  virtualStencil(parameters);
+    Stencils::MaxUStencil                                  typedStencil(parameters);
+    FieldIterator<FlowField>                               virtualIterator(virtualField, parameters, virtualStencil);
+    StencilFieldIterator<FlowField, Stencils::MaxUStencil> typedIterator(virtualField, parameters, typedStencil);
+    virtualStencil.reset();
+    typedStencil.reset();
+    virtualIterator.iterate();
+    typedIterator.iterate();
+    for (int d = 0; d < dim; d++) {
+      REQUIRE(typedStencil.getMaxValues()[d] > 0.0);
+      REQUIRE(typedStencil.getMaxValues()[d] == virtualStencil.getMaxValues()[d]);
+    }
+
+    // Above the stable time step of every cell, which the stencils reduce to
+    parameters.timestep.dt = 1.0;
+    Stencils::TimeStepStencil                                  virtualDt(parameters);
+    Stencils::TimeStepStencil                                  typedDt(parameters);
+    FieldIterator<FlowField>                                   virtualDtIterator(virtualField, parameters, virtualDt);
+    StencilFieldIterator<FlowField, Stencils::TimeStepStencil> typedDtIterator(virtualField, parameters, typedDt);
+    virtualDtIterator.iterate();
+    typedDtIterator.iterate();
+    REQUIRE(typedDt.dt < parameters.timestep.dt);
+    REQUIRE(typedDt.dt == virtualDt.dt);
+  }
+
+  spdlog::info("Test for stencil-typed field iteration completed successfully");
+}
+
+TEST_CASE("Test fused FGH and RHS sweep", "[single-file]") {
+  spdlog::info("Testing fused FGH and RHS sweep");
+
+  for (const std::string scenario : {"cavity", "channel"}) {
+    for (int dim = 2; dim <= 3; dim++) {
+      Parameters parameters;
+      setUpCavity(parameters, dim, 40);
+      parameters.simulation.scenario = scenario;
+      parameters.bfStep.xRatio       = -1.0;
+      parameters.bfStep.yRatio       = -1.0;
+      for (int d = 0; d < 3; d++) {
+        parameters.walls.vectorLeft[d]   = 0.0;
+        parameters.walls.vectorRight[d]  = 0.0;
+        parameters.walls.vectorBottom[d] = 0.0;
+        parameters.walls.vectorTop[d]    = (d == 0) ? 1.0 : 0.0;
+        parameters.walls.vectorFront[d]  = 0.0;
+        parameters.walls.vectorBack[d]   = 0.0;
+      }
+      GlobalBoundaryFactory globalBoundaryFactory(parameters);
+      FlowField             separateField(parameters);
+      FlowField             fusedField(parameters);
+      fillFields(separateField);
+      fillFields(fusedField);
+
+      // Three sweeps, as the simulation did before
+      Stencils::FGHStencil                                  fghStencil(parameters);
+      Stencils::RHSStencil                                  rhsStencil(parameters);
+      StencilFieldIterator<FlowField, Stencils::FGHStencil> fghIterator(separateField, parameters, fghStencil);
+      StencilFieldIterator<FlowField, Stencils::RHSStencil> rhsIterator(separateField, parameters, rhsStencil);
+
+      auto wallFGHIterator = globalBoundaryFactory.getGlobalBoundaryFGHIterator(separateField);
+      fghIterator.iterate();
+      wallFGHIterator.iterate();
+      rhsIterator.iterate();
+
+      FGHRHSIterator<Stencils::FGHStencil> fusedIterator(
+        fusedField, parameters, fghStencil, rhsStencil, globalBoundaryFactory
+      );
+      fusedIterator.iterate();
+
+      // All values of FGH which are read later, and the right-hand side of all inner cells
+      const int cellsZ = (dim == 3) ? fusedField.getCellsZ() - 1 : 1;
+      for (int k = (dim == 3) ? 1 : 0; k < cellsZ; k++) {
+        for (int j = 1; j < fusedField.getCellsY() - 1; j++) {
+          for (int i = 1; i < fusedField.getCellsX() - 1; i++) {
+            for (int d = 0; d < dim; d++) {
+              REQUIRE(fusedField.getFGH().getVector(i, j, k)[d] == separateField.getFGH().getVector(i, j, k)[d]);
+            }
+            if (i >= 2 && j >= 2 && (dim == 2 || k >= 2)) {
+              REQUIRE(fusedField.getRHS().getScalar(i, j, k) == separateField.getRHS().getScalar(i, j, k));
+            }
+          }
+        }
+      }
+    }
+  }
+
+  spdlog::info("Test for fused FGH and RHS sweep completed successfully");
+}
+
+TEST_CASE("Test fused velocity update", "[single-file]") {
+  spdlog::info("Testing fused velocity update");
+
+  for (const std::string scenario : {"cavity", "channel"}) {
+    for (int dim = 2; dim <= 3; dim++) {
+      Parameters parameters;
+      setUpCavity(parameters, dim, 40);
+      parameters.simulation.scenario = scenario;
+      parameters.bfStep.xRatio       = 0.3;
+      parameters.bfStep.yRatio       = 0.4;
+      for (int d = 0; d < 3; d++) {
+        parameters.walls.vectorLeft[d]   = (d == 0) ? 1.0 : 0.0;
+        parameters.walls.vectorRight[d]  = 0.0;
+        parameters.walls.vectorBottom[d] = 0.0;
+        parameters.walls.vectorTop[d]    = (d == 0) ? 1.0 : 0.0;
+        parameters.walls.vectorFront[d]  = 0.0;
+        parameters.walls.vectorBack[d]   = 0.0;
+      }
+      GlobalBoundaryFactory globalBoundaryFactory(parameters);
+      FlowField             separateField(parameters);
+      FlowField             maxUField(parameters);
+      FlowField             timeStepField(parameters);
+      for (FlowField* flowField : {&separateField, &maxUField, &timeStepField}) {
+        fillFields(*flowField);
+        if (scenario == "channel") {
+          // The step reaches into the ghost cells, so that obstacle cells lie in the inner and in the outer layers
+          Stencils::BFStepInitStencil stepStencil(parameters);
+          FieldIterator<FlowField>    stepIterator(*flowField, parameters, stepStencil, 0, 1);
+          stepIterator.iterate();
+        }
+      }
+
+      // Three sweeps, as the simulation did before
+      Stencils::VelocityStencil                                  velocityStencil(parameters);
+      Stencils::ObstacleStencil                                  obstacleStencil(parameters);
+      Stencils::MaxUStencil                                      separateMaxU(parameters);
+      Stencils::TimeStepStencil                                  separateDt(parameters);
+      StencilFieldIterator<FlowField, Stencils::VelocityStencil> velocityIterator(
+        separateField, parameters, velocityStencil
+      );
+      StencilFieldIterator<FlowField, Stencils::ObstacleStencil> obstacleIterator(
+        separateField, parameters, obstacleStencil
+      );
+      StencilFieldIterator<FlowField, Stencils::MaxUStencil> maxUIterator(separateField, parameters, separateMaxU);
+      StencilFieldIterator<FlowField, Stencils::TimeStepStencil> dtIterator(separateField, parameters, separateDt);
+
+      auto wallVelocityIterator = globalBoundaryFactory.getGlobalBoundaryVelocityIterator(separateField);
+      velocityIterator.iterate();
+      obstacleIterator.iterate();
+      wallVelocityIterator.iterate();
+      separateMaxU.reset();
+      maxUIterator.iterate();
+      dtIterator.iterate();
+
+      // The fused sweeps, with the walls applied before the outer layers are reduced
+      Stencils::MaxUStencil                         fusedMaxU(parameters);
+      VelocityUpdateIterator<Stencils::MaxUStencil> maxUUpdateIterator(
+        maxUField, parameters, velocityStencil, obstacleStencil, fusedMaxU
+      );
+      auto maxUWallIterator = globalBoundaryFactory.getGlobalBoundaryVelocityIterator(maxUField);
+      fusedMaxU.reset();
+      maxUUpdateIterator.iterate();
+      maxUWallIterator.iterate();
+      maxUUpdateIterator.reduceOuterLayers();
+
+      Stencils::TimeStepStencil                         fusedDt(parameters);
+      VelocityUpdateIterator<Stencils::TimeStepStencil> dtUpdateIterator(
+        timeStepField, parameters, velocityStencil, obstacleStencil, fusedDt
+      );
+      auto dtWallIterator = globalBoundaryFactory.getGlobalBoundaryVelocityIterator(timeStepField);
+      dtUpdateIterator.iterate();
+      dtWallIterator.iterate();
+      dtUpdateIterator.reduceOuterLayers();
+
+      requireEqual(separateField.getVelocity(), maxUField.getVelocity(), dim);
+      requireEqual(separateField.getVelocity(), timeStepField.getVelocity(), dim);
+      for (int d = 0; d < dim; d++) {
+        REQUIRE(fusedMaxU.getMaxValues()[d] == separateMaxU.getMaxValues()[d]);
+      }
+      REQUIRE(fusedDt.dt == separateDt.dt);
+    }
+  }
+
+  spdlog::info("Test for fused velocity update completed successfully");
+}
+
+template <class StencilType>
+static void benchmarkStencil(const std::string& name, int dim, int cells) {
+  Parameters parameters;
+  setUpCavity(parameters, dim, cells);
+  FlowField flowField(parameters);
+  fillFields(flowField);
+
+  StencilType                                  stencil(parameters);
+  FieldIterator<FlowField>                     virtualIterator(flowField, parameters, stencil);
+  StencilFieldIterator<FlowField, StencilType> typedIterator(flowField, parameters, stencil);
+
+  const std::string label = name + ", " + std::to_string(dim) + "D";
+  BENCHMARK(label + ", virtual") { virtualIterator.iterate(); };
+  BENCHMARK(label + ", typed") { typedIterator.iterate(); };
+}
+
+// Run with: ./IteratorTest "[benchmark]"
+TEST_CASE("Benchmark stencil-typed field iteration", "[.][benchmark]") {
+  for (const auto& [dim, cells] : {std::pair{2, 1024}, std::pair{3, 96}}) {
+    benchmarkStencil<Stencils::FGHStencil>("FGH", dim, cells);
+    benchmarkStencil<Stencils::RHSStencil>("RHS", dim, cells);
+    benchmarkStencil<Stencils::VelocityStencil>("Velocity", dim, cells);
+    benchmarkStencil<Stencils::ObstacleStencil>("Obstacle", dim, cells);
+    benchmarkStencil<Stencils::MaxUStencil>("MaxU", dim, cells);
+  }
+}
+
+// Run with: ./IteratorTest "[benchmark]"
+TEST_CASE("Benchmark threaded field iteration", "[.][benchmark]") {
+  Parameters parameters;
+  setUpCavity(parameters, 3, 96);
+  FlowField flowField(parameters);
+  fillFields(flowField);
+
+  Stencils::FGHStencil                                  stencil(parameters);
+  StencilFieldIterator<FlowField, Stencils::FGHStencil> iterator(flowField, parameters, stencil);
+
+#ifdef _OPENMP
+  const int maxThreads = omp_get_max_threads();
+#else
+  const int maxThreads = 1;
+#endif
+  for (int threads = 1; threads <= maxThreads; threads *= 2) {
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+    BENCHMARK("FGH, 3D, " + std::to_string(threads) + " threads") { iterator.iterate(); };
+  }
+#ifdef _OPENMP
+  omp_set_num_threads(maxThreads);
+#endif
+}
+
+// Run with: ./IteratorTest "[benchmark]"
+TEST_CASE("Benchmark fused FGH and RHS sweep", "[.][benchmark]") {
+  for (const auto& [dim, cells] : {std::pair{2, 1024}, std::pair{3, 96}}) {
+    Parameters parameters;
+    setUpCavity(parameters, dim, cells);
+    parameters.simulation.scenario = "channel";
+    parameters.bfStep.xRatio       = -1.0;
+    parameters.bfStep.yRatio       = -1.0;
+    for (int d = 0; d < 3; d++) {
+      parameters.walls.vectorBottom[d] = 0.0;
+      parameters.walls.vectorTop[d]    = 0.0;
+      parameters.walls.vectorFront[d]  = 0.0;
+      parameters.walls.vectorBack[d]   = 0.0;
+    }
+    GlobalBoundaryFactory globalBoundaryFactory(parameters);
+    FlowField             flowField(parameters);
+    fillFields(flowField);
+
+    Stencils::FGHStencil                                  fghStencil(parameters);
+    Stencils::RHSStencil                                  rhsStencil(parameters);
+    StencilFieldIterator<FlowField, Stencils::FGHStencil> fghIterator(flowField, parameters, fghStencil);
+    StencilFieldIterator<FlowField, Stencils::RHSStencil> rhsIterator(flowField, parameters, rhsStencil);
+    FGHRHSIterator<Stencils::FGHStencil>                  fusedIterator(
+      flowField, parameters, fghStencil, rhsStencil, globalBoundaryFactory
+    );
+
+    auto wallFGHIterator = globalBoundaryFactory.getGlobalBoundaryFGHIterator(flowField);
+
+    const std::string label = std::to_string(dim) + "D";
+    BENCHMARK(label + ", separate") {
+      fghIterator.iterate();
+      wallFGHIterator.iterate();
+      rhsIterator.iterate();
+    };
+    BENCHMARK(label + ", fused") { fusedIterator.iterate(); };
+  }
+}
+
+// Run with: ./IteratorTest "[benchmark]"
+TEST_CASE("Benchmark fused velocity update", "[.][benchmark]") {
+  for (const auto& [dim, cells] : {std::pair{2, 1024}, std::pair{3, 96}}) {
+    Parameters parameters;
+    setUpCavity(parameters, dim, cells);
+    FlowField flowField(parameters);
+    fillFields(flowField);
+
+    Stencils::VelocityStencil                                  velocityStencil(parameters);
+    Stencils::ObstacleStencil                                  obstacleStencil(parameters);
+    Stencils::MaxUStencil                                      maxUStencil(parameters);
+    StencilFieldIterator<FlowField, Stencils::VelocityStencil> velocityIterator(flowField, parameters, velocityStencil);
+    StencilFieldIterator<FlowField, Stencils::ObstacleStencil> obstacleIterator(flowField, parameters, obstacleStencil);
+    StencilFieldIterator<FlowField, Stencils::MaxUStencil>     maxUIterator(flowField, parameters, maxUStencil);
+    VelocityUpdateIterator<Stencils::MaxUStencil>              fusedIterator(
+      flowField, parameters, velocityStencil, obstacleStencil, maxUStencil
+    );
+
+    const std::string label = std::to_string(dim) + "D";
+    BENCHMARK(label + ", separate") {
+      velocityIterator.iterate();
+      obstacleIterator.iterate();
+      maxUIterator.iterate();
+    };
+    BENCHMARK(label + ", fused") {
+      fusedIterator.iterate();
+      fusedIterator.reduceOuterLayers();
+    };
+  }
+}
@@ -0,0 +1,32 @@
+#include "StdAfx.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "ParallelManagers/LoadBalancer.hpp"
+
+TEST_CASE("Test partitioning the work of the layers", "[single-file]") {
+  using ParallelManagers::LoadBalancer;
+
+  // Uniform work is split evenly
+  REQUIRE(LoadBalancer::partition(std::vector<RealType>(12, 1.0), 4, 2) == std::vector<int>{3, 3, 3, 3});
+
+  // Particles piled up at the inlet make the first parts thinner
+  std::vector<RealType> work(20, 1.0);
+  for (int c = 0; c < 4; c++) {
+    work[c] += 9.0;
+  }
+  REQUIRE(LoadBalancer::partition(work, 4, 2) == std::vector<int>{2, 2, 8, 8});
+
+  // No part gets fewer than the minimum number of layers, even if a single layer holds most of the work
+  std::vector<RealType> peak(10, 1.0);
+  peak[0] = 1000.0;
+  REQUIRE(LoadBalancer::partition(peak, 3, 2) == std::vector<int>{2, 4, 4});
+  peak[0] = 1.0;
+  peak[9] = 1000.0;
+
+  const std::vector<int> cells = LoadBalancer::partition(peak, 3, 2);
+  REQUIRE(std::accumulate(cells.begin(), cells.end(), 0) == 10);
+  REQUIRE(cells[2] == 2);
+
+  REQUIRE_THROWS(LoadBalancer::partition(std::vector<RealType>(5, 1.0), 3, 2));
+}
@@ -0,0 +1,55 @@
+#include "StdAfx.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "Meshsize.hpp"
+#include "Parameters.hpp"
+
+constexpr auto SIZE_X = 20;
+constexpr auto SIZE_Y = 30;
+constexpr auto SIZE_Z = 10;
+
+// Every coordinate has to lie between the lower corner of its cell and the lower corner of the next cell
+static void checkLocateCell(const Meshsize& meshsize, const Parameters& parameters) {
+  const int      sizes[3]   = {parameters.geometry.sizeX, parameters.geometry.sizeY, parameters.geometry.sizeZ};
+  const RealType lengths[3] = {parameters.geometry.lengthX, parameters.geometry.lengthY, parameters.geometry.lengthZ};
+
+  for (int d = 0; d < 3; d++) {
+    const auto position = [&](int c) {
+      return (d == 0) ? meshsize.getPosX(c, 0, 0) : (d == 1) ? meshsize.getPosY(0, c, 0) : meshsize.getPosZ(0, 0, c);
+    };
+
+    // Sample beyond the domain on both sides, including all vertices
+    for (int sample = -4 * sizes[d]; sample <= 8 * sizes[d]; sample++) {
+      const RealType coordinate = lengths[d] * sample / (4 * sizes[d]) - lengths[d];
+      const int      c          = meshsize.locateCell(d, coordinate);
+      REQUIRE(position(c) <= coordinate);
+      REQUIRE(coordinate < position(c + 1));
+    }
+    for (int c = -2; c < sizes[d] + 6; c++) {
+      REQUIRE(meshsize.locateCell(d, position(c)) == c);
+    }
+  }
+}
+
+TEST_CASE("Test cell lookup", "[single-file]") {
+  spdlog::info("Testing cell lookup");
+
+  Parameters parameters;
+  parameters.geometry.dim            = 3;
+  parameters.geometry.sizeX          = SIZE_X;
+  parameters.geometry.sizeY          = SIZE_Y;
+  parameters.geometry.sizeZ          = SIZE_Z;
+  parameters.geometry.lengthX        = 2.0;
+  parameters.geometry.lengthY        = 1.0;
+  parameters.geometry.lengthZ        = 0.3;
+  parameters.parallel.firstCorner[0] = 5;
+  parameters.parallel.firstCorner[1] = 0;
+  parameters.parallel.firstCorner[2] = 3;
+
+  checkLocateCell(UniformMeshsize(parameters), parameters);
+  checkLocateCell(TanhMeshStretching(parameters, true, true, false), parameters);
+  checkLocateCell(TanhMeshStretching(parameters, false, true, true), parameters);
+
+  spdlog::info("Test for cell lookup completed successfully");
+}
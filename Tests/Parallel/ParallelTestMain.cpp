@@ -0,0 +1,21 @@
+#include "StdAfx.hpp"
+
+#include <catch2/catch_session.hpp>
+
+// Runs the tests on every process between the initialisation and the finalisation of MPI
+int main(int argc, char* argv[]) {
+#ifdef ENABLE_PETSC
+  PetscInitialize(&argc, &argv, PETSC_NULL, PETSC_NULL);
+#else
+  MPI_Init(&argc, &argv);
+#endif
+
+  const int result = Catch::Session().run(argc, argv);
+
+#ifdef ENABLE_PETSC
+  PetscFinalize();
+#else
+  MPI_Finalize();
+#endif
+  return result;
+}
@@ -0,0 +1,265 @@
+#include "StdAfx.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "FlowField.hpp"
+#include "FlowFieldCheckpoint.hpp"
+#include "Meshsize.hpp"
+#include "ParticleSimulation.hpp"
+
+#include "ParallelManagers/PetscParallelConfiguration.hpp"
+
+constexpr auto SIZE_X = 32;
+constexpr auto SIZE_Y = 32;
+constexpr auto SIZE_Z = 16;
+
+// Channel of unit length, split among the given processors along each axis. The configuration of the processors has
+// to be created afterwards, followed by the mesh size.
+static void setUpChannel(Parameters& parameters, int dim, const std::array<int, 3>& processors, int particleCount) {
+  parameters.geometry.dim              = dim;
+  parameters.geometry.sizeX            = SIZE_X;
+  parameters.geometry.sizeY            = SIZE_Y;
+  parameters.geometry.sizeZ            = (dim == 3) ? SIZE_Z : 1;
+  parameters.geometry.lengthX          = 1.0;
+  parameters.geometry.lengthY          = 1.0;
+  parameters.geometry.lengthZ          = 1.0;
+  parameters.parallel.numProcessors[0] = processors[0];
+  parameters.parallel.numProcessors[1] = processors[1];
+  parameters.parallel.numProcessors[2] = processors[2];
+  parameters.simulation.scenario       = "channel";
+  parameters.bfStep.xRatio             = -1.0;
+  parameters.bfStep.yRatio             = -1.0;
+  parameters.particles.particleCount   = particleCount;
+}
+
+// Uniform velocity everywhere, including the ghost layers
+static void fillVelocity(FlowField& flowField, const std::array<RealType, 3>& velocity) {
+  const int dim = (flowField.getCellsZ() > 1) ? 3 : 2;
+  for (int k = 0; k < flowField.getCellsZ(); k++) {
+    for (int j = 0; j < flowField.getCellsY(); j++) {
+      for (int i = 0; i < flowField.getCellsX(); i++) {
+        std::copy(velocity.begin(), velocity.begin() + dim, flowField.getVelocity().getVector(i, j, k));
+      }
+    }
+  }
+}
+
+static int getNumberOfProcesses() {
+  int nproc;
+  MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+  return nproc;
+}
+
+static int sumOverProcesses(int value) {
+  MPI_Allreduce(MPI_IN_PLACE, &value, 1, MPI_INT, MPI_SUM, PETSC_COMM_WORLD);
+  return value;
+}
+
+TEST_CASE("Test particle checkpoint", "[parallel]") {
+  spdlog::info("Testing particle checkpoint");
+
+  const int  nproc = getNumberOfProcesses();
+  Parameters parameters;
+  setUpChannel(parameters, 2, {2, nproc / 2, 1}, 8);
+  ParallelManagers::PetscParallelConfiguration configuration(parameters);
+  parameters.meshsize             = new UniformMeshsize(parameters);
+  parameters.vtk.prefix           = "ParticleCheckpointTest";
+  parameters.particles.statistics = "means";
+  const int rank                  = parameters.parallel.rank;
+  if (rank == 0) {
+    std::filesystem::remove_all("Output/" + parameters.vtk.prefix);
+    std::filesystem::create_directories("Output/" + parameters.vtk.prefix);
+  }
+  MPI_Barrier(PETSC_COMM_WORLD);
+
+  // Every cell holds its global numbers as pressure
+  FlowField flowField(parameters);
+  fillVelocity(flowField, {1.0, 0.1, 0.0});
+  for (int j = 2; j < parameters.parallel.localSize[1] + 2; j++) {
+    for (int i = 2; i < parameters.parallel.localSize[0] + 2; i++) {
+      flowField.getPressure().getScalar(i, j) = (parameters.parallel.firstCorner[1] + j) * SIZE_X
+                                                + parameters.parallel.firstCorner[0] + i;
+    }
+  }
+
+  ParticleSimulation<2> particleSimulation(parameters, flowField);
+  particleSimulation.initializeParticles();
+  particleSimulation.advectParticles(0.01);
+  particleSimulation.communicateParticles();
+  particleSimulation.initializeParticles();
+  particleSimulation.advectParticles(0.01);
+  particleSimulation.communicateParticles();
+  particleSimulation.writeCheckpoint(2, 0.5);
+
+  // Every rank has written its checkpoint once the generation is committed
+  const std::string fileName = ParticleCheckpoint::getFileName(parameters.vtk.prefix, rank, 2);
+  REQUIRE(!std::filesystem::exists(fileName + ".tmp"));
+  REQUIRE(ParticleCheckpoint::readCommit(parameters.vtk.prefix) == 2);
+  for (int r = 0; r < nproc; r++) {
+    REQUIRE(std::filesystem::exists(ParticleCheckpoint::getFileName(parameters.vtk.prefix, r, 2)));
+    REQUIRE(std::filesystem::exists(FlowFieldCheckpoint::getFileName(parameters.vtk.prefix, r, 2)));
+  }
+
+  const ParticleCheckpoint::Checkpoint checkpoint = ParticleCheckpoint::read(fileName);
+  REQUIRE(checkpoint.header.dim == 2);
+  REQUIRE(checkpoint.header.ranks == nproc);
+  REQUIRE(checkpoint.header.timeSteps == 2);
+  REQUIRE(checkpoint.header.time == RealType(0.01) + RealType(0.01));
+  REQUIRE(checkpoint.header.timeInject == 0.5);
+  REQUIRE(checkpoint.injectionTimes == std::vector<double>{0.0, 0.01});
+  REQUIRE(checkpoint.sums == particleSimulation.getStatistics()[0]->getSums());
+
+  // Cells are stored in the global numbering, without the ghost layers
+  const ParticleContainer<2>& particles = particleSimulation.getParticles();
+  REQUIRE(static_cast<int>(checkpoint.records.size()) == particles.size());
+  REQUIRE(sumOverProcesses(particles.size()) == 2 * 8);
+  for (int p = 0; p < particles.size(); p++) {
+    const ParticleCheckpoint::Record& record = checkpoint.records[p];
+    REQUIRE(record.id == particles.getIds()[p]);
+    REQUIRE(record.injection == particles.getInjections()[p]);
+    for (int d = 0; d < 2; d++) {
+      REQUIRE(record.index[d] == particles.getIndices(d)[p] + parameters.parallel.firstCorner[d] - 2);
+      REQUIRE(record.position[d] == particles.getPositions(d)[p]);
+      REQUIRE(record.velocity[d] == particles.getVelocities(d)[p]);
+    }
+    REQUIRE(record.position[2] == 0.0);
+  }
+  REQUIRE(ParticleCheckpoint::read(fileName, false).records.empty());
+
+  // The next generation replaces the previous one on all ranks
+  particleSimulation.writeCheckpoint(3, 0.5);
+  REQUIRE(ParticleCheckpoint::readCommit(parameters.vtk.prefix) == 3);
+  MPI_Barrier(PETSC_COMM_WORLD);
+  for (int r = 0; r < nproc; r++) {
+    REQUIRE(!std::filesystem::exists(ParticleCheckpoint::getFileName(parameters.vtk.prefix, r, 2)));
+    REQUIRE(!std::filesystem::exists(FlowFieldCheckpoint::getFileName(parameters.vtk.prefix, r, 2)));
+  }
+
+  // A restart hands every particle and every cell back to the rank it belongs to
+  FlowField             restoredField(parameters);
+  ParticleSimulation<2> restored(parameters, restoredField);
+  const ParticleCheckpoint::State state = restored.readCheckpoint(parameters.vtk.prefix);
+  REQUIRE(state.timeSteps == 3);
+  REQUIRE(state.time == checkpoint.header.time);
+  REQUIRE(state.timeInject == 0.5);
+  REQUIRE(restored.getStatistics()[0]->getSums() == particleSimulation.getStatistics()[0]->getSums());
+
+  const ParticleContainer<2>& restoredParticles = restored.getParticles();
+  std::set<std::int64_t>      ids(particles.getIds(), particles.getIds() + particles.size());
+  REQUIRE(std::set<std::int64_t>(restoredParticles.getIds(), restoredParticles.getIds() + restoredParticles.size())
+          == ids);
+  for (int j = 2; j < parameters.parallel.localSize[1] + 2; j++) {
+    for (int i = 2; i < parameters.parallel.localSize[0] + 2; i++) {
+      REQUIRE(restoredField.getPressure().getScalar(i, j) == flowField.getPressure().getScalar(i, j));
+      REQUIRE(restoredField.getVelocity().getVector(i, j)[0] == 1.0);
+    }
+  }
+
+  // The flow field checkpoints of all ranks of the previous run have to be present
+  REQUIRE_THROWS_AS(
+    FlowFieldCheckpoint::read(parameters.vtk.prefix, nproc + 1, 3, restoredField, parameters), std::runtime_error
+  );
+
+  // A checkpoint cut off while writing is rejected
+  MPI_Barrier(PETSC_COMM_WORLD);
+  const std::string nextName = ParticleCheckpoint::getFileName(parameters.vtk.prefix, rank, 3);
+  std::filesystem::resize_file(nextName, std::filesystem::file_size(nextName) - 1);
+  REQUIRE_THROWS_AS(ParticleCheckpoint::read(nextName), std::runtime_error);
+
+  spdlog::info("Test for particle checkpoint completed successfully");
+}
+
+// Positions of the particles of all ranks by their identifiers
+template <int Dim>
+static std::map<std::int64_t, std::array<RealType, Dim>> gatherParticles(const ParticleContainer<Dim>& particles) {
+  std::vector<double> local;
+  for (int p = 0; p < particles.size(); p++) {
+    local.push_back(static_cast<double>(particles.getIds()[p]));
+    for (int d = 0; d < Dim; d++) {
+      local.push_back(particles.getPositions(d)[p]);
+    }
+  }
+
+  const int        nproc = getNumberOfProcesses();
+  int              size  = local.size();
+  std::vector<int> sizes(nproc), displs(nproc);
+  MPI_Allgather(&size, 1, MPI_INT, sizes.data(), 1, MPI_INT, PETSC_COMM_WORLD);
+  std::exclusive_scan(sizes.begin(), sizes.end(), displs.begin(), 0);
+  std::vector<double> global(displs.back() + sizes.back());
+  MPI_Allgatherv(
+    local.data(), size, MPI_DOUBLE, global.data(), sizes.data(), displs.data(), MPI_DOUBLE, PETSC_COMM_WORLD
+  );
+
+  std::map<std::int64_t, std::array<RealType, Dim>> positions;
+  for (std::size_t n = 0; n < global.size(); n += 1 + Dim) {
+    std::array<RealType, Dim>& position = positions[static_cast<std::int64_t>(global[n])];
+    std::copy(global.begin() + n + 1, global.begin() + n + 1 + Dim, position.begin());
+  }
+  return positions;
+}
+
+// Moves the particles injected at the inlet through a uniform flow for one time unit, which takes them across the
+// subdomains of the given processors, and checks that the exchange hands every particle unchanged to its owner
+template <int Dim>
+static void checkMigration(const std::array<int, 3>& processors, const std::array<RealType, 3>& velocity) {
+  Parameters parameters;
+  setUpChannel(parameters, Dim, processors, 8);
+  ParallelManagers::PetscParallelConfiguration configuration(parameters);
+  parameters.meshsize = new UniformMeshsize(parameters);
+  FlowField flowField(parameters);
+  fillVelocity(flowField, velocity);
+
+  ParticleSimulation<Dim> particleSimulation(parameters, flowField);
+  particleSimulation.initializeParticles();
+  particleSimulation.advectParticles(1.0);
+
+  // The particles which left the subdomain stay in the container until the exchange
+  const ParticleContainer<Dim>&                           particles = particleSimulation.getParticles();
+  const std::map<std::int64_t, std::array<RealType, Dim>> expected  = gatherParticles(particles);
+  REQUIRE(expected.size() == ((Dim == 3) ? 8 * 8 : 8));
+
+  particleSimulation.communicateParticles();
+  const std::map<std::int64_t, std::array<RealType, Dim>> actual = gatherParticles(particles);
+  REQUIRE(actual.size() == expected.size());
+  for (const auto& [id, position] : expected) {
+    REQUIRE(actual.count(id) == 1);
+    for (int d = 0; d < Dim; d++) {
+      REQUIRE(std::abs(actual.at(id)[d] - position[d]) < 1e-6);
+    }
+  }
+
+  // Every particle is owned by the subdomain of its cell, which contains its position
+  const RealType spacings[3] = {1.0 / SIZE_X, 1.0 / SIZE_Y, 1.0 / SIZE_Z};
+  for (int p = 0; p < particles.size(); p++) {
+    for (int d = 0; d < Dim; d++) {
+      const int cell = particles.getIndices(d)[p] + parameters.parallel.firstCorner[d] - 2;
+      REQUIRE(particles.getIndices(d)[p] >= 2);
+      REQUIRE(particles.getIndices(d)[p] < parameters.parallel.localSize[d] + 2);
+      REQUIRE(particles.getPositions(d)[p] >= cell * spacings[d] - 1e-6);
+      REQUIRE(particles.getPositions(d)[p] <= (cell + 1) * spacings[d] + 1e-6);
+    }
+  }
+}
+
+TEST_CASE("Test particle migration across faces and corners", "[parallel]") {
+  spdlog::info("Testing particle migration across faces and corners");
+
+  // Particles starting in the lower subdomains at the inlet end up in all of them, diagonal neighbours included
+  const int nproc = getNumberOfProcesses();
+  checkMigration<2>({2, nproc / 2, 1}, {0.7, 0.55, 0.0});
+  checkMigration<3>({2, 2, nproc / 4}, {0.7, 0.55, 0.55});
+  checkMigration<3>({1, 2, nproc / 2}, {0.3, 0.55, 0.55});
+
+  spdlog::info("Test for particle migration across faces and corners completed successfully");
+}
+
+TEST_CASE("Test particle migration across several subdomains", "[parallel]") {
+  spdlog::info("Testing particle migration across several subdomains");
+
+  // The particles cross the subdomains between the inlet and their owners within a single exchange
+  const int nproc = getNumberOfProcesses();
+  checkMigration<2>({nproc, 1, 1}, {0.8, 0.3, 0.0});
+  checkMigration<3>({nproc, 1, 1}, {0.8, 0.3, 0.2});
+
+  spdlog::info("Test for particle migration across several subdomains completed successfully");
+}
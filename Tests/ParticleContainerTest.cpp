@@ -0,0 +1,228 @@
+#include "StdAfx.hpp"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "FlowField.hpp"
+#include "Meshsize.hpp"
+#include "ParticleContainer.hpp"
+#include "ParticleSimulation.hpp"
+
+constexpr auto NUMBER_OF_PARTICLES = 100;
+
+constexpr auto SIZE_X          = 32;
+constexpr auto SIZE_Y          = 32;
+constexpr auto SIZE_Z          = 32;
+constexpr auto PARTICLES_PER_Y = 256; // Results in 256 * 256 particles in the benchmark
+
+TEST_CASE("Test particle container", "[single-file]") {
+  spdlog::info("Testing particle container");
+
+  ParticleContainer<3> particles;
+
+  for (int p = 0; p < NUMBER_OF_PARTICLES; p++) {
+    REQUIRE(particles.add({1.0 * p, 2.0 * p, 3.0 * p}, {p, p + 1, p + 2}, p, 1000 + p) == p);
+  }
+  REQUIRE(particles.size() == NUMBER_OF_PARTICLES);
+
+  // All component arrays have to be aligned to a cache line
+  for (int d = 0; d < 3; d++) {
+    REQUIRE(reinterpret_cast<std::uintptr_t>(particles.getPositions(d)) % CACHE_LINE_SIZE == 0);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(particles.getVelocities(d)) % CACHE_LINE_SIZE == 0);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(particles.getIndices(d)) % CACHE_LINE_SIZE == 0);
+  }
+
+  // Removing a particle moves the last one into its slot
+  particles.remove(10);
+  REQUIRE(particles.size() == NUMBER_OF_PARTICLES - 1);
+  REQUIRE(particles.getX(10) == NUMBER_OF_PARTICLES - 1);
+  REQUIRE(particles.getZ(10) == 3 * (NUMBER_OF_PARTICLES - 1));
+  REQUIRE(particles.getK(10) == NUMBER_OF_PARTICLES + 1);
+  REQUIRE(particles.getInjection(10) == NUMBER_OF_PARTICLES - 1);
+  REQUIRE(particles.getId(10) == 1000 + NUMBER_OF_PARTICLES - 1);
+
+  // Removing the last particle only shrinks the container
+  particles.remove(particles.size() - 1);
+  REQUIRE(particles.size() == NUMBER_OF_PARTICLES - 2);
+  REQUIRE(particles.getX(particles.size() - 1) == NUMBER_OF_PARTICLES - 3);
+
+  // Truncating removes the particles from the back
+  particles.truncate(10);
+  REQUIRE(particles.size() == 10);
+  REQUIRE(particles.getX(9) == 9);
+
+  particles.clear();
+  REQUIRE(particles.empty());
+
+  spdlog::info("Test for particle container completed successfully");
+}
+
+TEST_CASE("Test sorting particles by cell", "[single-file]") {
+  spdlog::info("Testing sorting particles by cell");
+
+  // Particles in random cells, with the coordinates telling where they were added
+  std::mt19937                       generator(42);
+  std::uniform_int_distribution<int> distribution(0, SIZE_X - 1);
+  ParticleContainer<3>               particles;
+  for (int p = 0; p < NUMBER_OF_PARTICLES; p++) {
+    particles.add(
+      {1.0 * p, 0.0, 0.0}, {distribution(generator), distribution(generator), distribution(generator)}, p, 2 * p
+    );
+  }
+  particles.add(
+    {1.0 * NUMBER_OF_PARTICLES, 0.0, 0.0}, {SIZE_X, -1, 0}, NUMBER_OF_PARTICLES, 2 * NUMBER_OF_PARTICLES
+  ); // Outside of the field
+
+  particles.sortByCell({SIZE_X, SIZE_Y, SIZE_Z});
+  REQUIRE(particles.size() == NUMBER_OF_PARTICLES + 1);
+
+  // The cells have to be in (k, j, i) order and particles of the same cell in the order they were added
+  const auto key = [&](int p) {
+    const int i = std::clamp(particles.getI(p), 0, SIZE_X - 1);
+    const int j = std::clamp(particles.getJ(p), 0, SIZE_Y - 1);
+    const int k = std::clamp(particles.getK(p), 0, SIZE_Z - 1);
+    return (k * SIZE_Y + j) * SIZE_X + i;
+  };
+  std::vector<bool> found(NUMBER_OF_PARTICLES + 1, false);
+  for (int p = 0; p < particles.size(); p++) {
+    found[static_cast<int>(particles.getX(p))] = true;
+    REQUIRE(particles.getInjection(p) == static_cast<int>(particles.getX(p)));
+    REQUIRE(particles.getId(p) == 2 * static_cast<int>(particles.getX(p)));
+    if (p > 0) {
+      REQUIRE(key(p - 1) <= key(p));
+      if (key(p - 1) == key(p)) {
+        REQUIRE(particles.getX(p - 1) < particles.getX(p));
+      }
+    }
+  }
+  REQUIRE(std::all_of(found.begin(), found.end(), [](bool f) { return f; }));
+
+  spdlog::info("Test for sorting particles by cell completed successfully");
+}
+
+// Layout of the particles before the structure-of-arrays container: one list node per particle, each of them
+// carrying references to the flow field and the parameters.
+class ListParticle {
+public:
+  RealType                x_, y_, z_;
+  std::array<RealType, 3> velocity_;
+  FlowField&              flowField_;
+  Parameters&             parameters_;
+  std::array<int, 3>      index_;
+
+  ListParticle(
+    RealType x, RealType y, RealType z, std::array<int, 3> index, FlowField& flowField, Parameters& parameters
+  ):
+    x_(x),
+    y_(y),
+    z_(z),
+    velocity_{},
+    flowField_(flowField),
+    parameters_(parameters),
+    index_(index) {}
+
+  void update(RealType dt) {
+    RealType* velocity1 = flowField_.getVelocity().getVector(index_[0], index_[1], index_[2]);
+    RealType* velocity2 = flowField_.getVelocity().getVector(index_[0] - 1, index_[1], index_[2]);
+    RealType* velocity3 = flowField_.getVelocity().getVector(index_[0], index_[1] - 1, index_[2]);
+    RealType* velocity4 = flowField_.getVelocity().getVector(index_[0], index_[1], index_[2] - 1);
+
+    RealType dx   = parameters_.meshsize->getDx(index_[0], index_[1], index_[2]);
+    RealType dy   = parameters_.meshsize->getDy(index_[0], index_[1], index_[2]);
+    RealType dz   = parameters_.meshsize->getDz(index_[0], index_[1], index_[2]);
+    RealType posX = parameters_.meshsize->getPosX(index_[0], index_[1], index_[2]);
+    RealType posY = parameters_.meshsize->getPosY(index_[0], index_[1], index_[2]);
+    RealType posZ = parameters_.meshsize->getPosZ(index_[0], index_[1], index_[2]);
+
+    velocity_[0] = velocity1[0] * (x_ - posX) / dx + velocity2[0] * (posX + dx - x_) / dx;
+    velocity_[1] = velocity1[1] * (y_ - posY) / dy + velocity3[1] * (posY + dy - y_) / dy;
+    velocity_[2] = velocity1[2] * (z_ - posZ) / dz + velocity4[2] * (posZ + dz - z_) / dz;
+
+    x_ += dt * velocity_[0];
+    y_ += dt * velocity_[1];
+    z_ += dt * velocity_[2];
+
+    while (parameters_.meshsize->getPosX(index_[0], 0, 0) + parameters_.meshsize->getDx(index_[0], 0, 0) <= x_) {
+      index_[0]++;
+    }
+    while (parameters_.meshsize->getPosY(0, index_[1], 0) + parameters_.meshsize->getDy(0, index_[1], 0) <= y_) {
+      index_[1]++;
+    }
+    while (parameters_.meshsize->getPosZ(0, 0, index_[2]) + parameters_.meshsize->getDz(0, 0, index_[2]) <= z_) {
+      index_[2]++;
+    }
+  }
+};
+
+// Run with: ./ParticleContainerTest "[benchmark]"
+TEST_CASE("Benchmark particle advection", "[.][benchmark]") {
+  Parameters parameters;
+  parameters.geometry.dim            = 3;
+  parameters.geometry.sizeX          = SIZE_X;
+  parameters.geometry.sizeY          = SIZE_Y;
+  parameters.geometry.sizeZ          = SIZE_Z;
+  parameters.geometry.lengthX        = 1.0;
+  parameters.geometry.lengthY        = 1.0;
+  parameters.geometry.lengthZ        = 1.0;
+  parameters.parallel.localSize[0]   = SIZE_X;
+  parameters.parallel.localSize[1]   = SIZE_Y;
+  parameters.parallel.localSize[2]   = SIZE_Z;
+  parameters.parallel.firstCorner[0] = 0;
+  parameters.parallel.firstCorner[1] = 0;
+  parameters.parallel.firstCorner[2] = 0;
+  parameters.simulation.scenario     = "channel";
+  parameters.bfStep.xRatio           = -1.0;
+  parameters.bfStep.yRatio           = -1.0;
+  parameters.particles.particleCount = PARTICLES_PER_Y;
+  parameters.timestep.dt             = 0.0; // Particles stay in place, so every sample does the same work
+  parameters.meshsize                = new UniformMeshsize(parameters);
+
+  FlowField flowField(parameters);
+  for (int k = 0; k < flowField.getCellsZ(); k++) {
+    for (int j = 0; j < flowField.getCellsY(); j++) {
+      for (int i = 0; i < flowField.getCellsX(); i++) {
+        flowField.getVelocity().getVector(i, j, k)[0] = 1.0;
+        flowField.getVelocity().getVector(i, j, k)[1] = 0.1 * j;
+        flowField.getVelocity().getVector(i, j, k)[2] = 0.1 * k;
+      }
+    }
+  }
+
+  ParticleSimulation<3> particleSimulation(parameters, flowField);
+  particleSimulation.initializeParticles();
+  const int numberOfParticles = particleSimulation.getNumberOfParticles();
+  REQUIRE(numberOfParticles > 0);
+
+  // Same number of particles at random positions, stored the way it used to be
+  std::mt19937                             generator(42);
+  std::uniform_real_distribution<RealType> distribution(0.0, 1.0);
+  std::list<ListParticle>                  listParticles;
+  const RealType                           dx = parameters.meshsize->getDxMin();
+  for (int p = 0; p < numberOfParticles; p++) {
+    const RealType x = distribution(generator);
+    const RealType y = distribution(generator);
+    const RealType z = distribution(generator);
+    listParticles.emplace_front(
+      x,
+      y,
+      z,
+      std::array<int, 3>{static_cast<int>(x / dx) + 2, static_cast<int>(y / dx) + 2, static_cast<int>(z / dx) + 2},
+      flowField,
+      parameters
+    );
+  }
+
+  spdlog::info("Advecting {} particles per sample", numberOfParticles);
+
+  BENCHMARK("std::list of particles") {
+    for (auto& particle : listParticles) {
+      particle.update(parameters.timestep.dt);
+    }
+    return listParticles.front().velocity_[0];
+  };
+
+  BENCHMARK("Structure-of-arrays container") {
+    particleSimulation.advectParticles(parameters.timestep.dt);
+    return particleSimulation.getNumberOfParticles();
+  };
+}
@@ -0,0 +1,616 @@
+#include "StdAfx.hpp"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "FlowField.hpp"
+#include "Iterators.hpp"
+#include "Meshsize.hpp"
+#include "ParticleSimulation.hpp"
+
+#include "Stencils/BFStepInitStencil.hpp"
+
+constexpr auto SIZE_X = 64;
+constexpr auto SIZE_Y = 64;
+constexpr auto SIZE_Z = 32;
+
+constexpr RealType TOLERANCE = 16 * std::numeric_limits<RealType>::epsilon();
+
+// Channel of unit length with a sheared velocity field
+static void setUpChannel(Parameters& parameters, int dim, int particleCount) {
+  parameters.geometry.dim              = dim;
+  parameters.geometry.sizeX            = SIZE_X;
+  parameters.geometry.sizeY            = SIZE_Y;
+  parameters.geometry.sizeZ            = (dim == 3) ? SIZE_Z : 1;
+  parameters.geometry.lengthX          = 1.0;
+  parameters.geometry.lengthY          = 1.0;
+  parameters.geometry.lengthZ          = 1.0;
+  parameters.parallel.localSize[0]     = parameters.geometry.sizeX;
+  parameters.parallel.localSize[1]     = parameters.geometry.sizeY;
+  parameters.parallel.localSize[2]     = parameters.geometry.sizeZ;
+  parameters.parallel.firstCorner[0]   = 0;
+  parameters.parallel.firstCorner[1]   = 0;
+  parameters.parallel.firstCorner[2]   = 0;
+  parameters.parallel.rank             = 0;
+  parameters.parallel.numProcessors[0] = 1;
+  parameters.parallel.numProcessors[1] = 1;
+  parameters.parallel.numProcessors[2] = 1;
+  parameters.simulation.scenario       = "channel";
+  parameters.bfStep.xRatio             = -1.0;
+  parameters.bfStep.yRatio             = -1.0;
+  parameters.particles.particleCount   = particleCount;
+  parameters.meshsize                  = new UniformMeshsize(parameters);
+}
+
+static void fillVelocity(FlowField& flowField) {
+  for (int k = 0; k < flowField.getCellsZ(); k++) {
+    for (int j = 0; j < flowField.getCellsY(); j++) {
+      for (int i = 0; i < flowField.getCellsX(); i++) {
+        RealType* velocity = (flowField.getCellsZ() > 1) ? flowField.getVelocity().getVector(i, j, k)
+                                                         : flowField.getVelocity().getVector(i, j);
+        velocity[0] = 1.0 + 0.01 * j;
+        velocity[1] = 0.05 * std::sin(0.3 * i);
+        if (flowField.getCellsZ() > 1) {
+          velocity[2] = 0.05 * std::cos(0.2 * i);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Test threaded particle advection", "[single-file]") {
+  spdlog::info("Testing threaded particle advection");
+
+  Parameters parameters;
+  setUpChannel(parameters, 3, 16);
+  FlowField flowField(parameters);
+  fillVelocity(flowField);
+
+  // Same particles, advected once by a single thread and once by all threads
+#ifdef _OPENMP
+  const int maxThreads = omp_get_max_threads();
+#endif
+  ParticleSimulation<3> sequential(parameters, flowField);
+  ParticleSimulation<3> threaded(parameters, flowField);
+  sequential.initializeParticles();
+  threaded.initializeParticles();
+  for (int step = 0; step < 10; step++) {
+#ifdef _OPENMP
+    omp_set_num_threads(1);
+#endif
+    sequential.advectParticles(0.01);
+#ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+    threaded.advectParticles(0.01);
+  }
+
+  const ParticleContainer<3>& expected = sequential.getParticles();
+  const ParticleContainer<3>& actual   = threaded.getParticles();
+  REQUIRE(actual.size() == expected.size());
+  for (int d = 0; d < 3; d++) {
+    for (int p = 0; p < expected.size(); p++) {
+      REQUIRE(actual.getPositions(d)[p] == expected.getPositions(d)[p]);
+      REQUIRE(actual.getIndices(d)[p] == expected.getIndices(d)[p]);
+    }
+  }
+
+  spdlog::info("Test for threaded particle advection completed successfully");
+}
+
+// Every component grows linearly along its own axis, which the interpolation has to reproduce exactly
+template <int Dim>
+static void checkInterpolation() {
+  Parameters parameters;
+  setUpChannel(parameters, Dim, 8);
+  FlowField flowField(parameters);
+
+  // Velocities are located on the right/top/back faces of the cells
+  const Meshsize& meshsize = *parameters.meshsize;
+  for (int k = 0; k < flowField.getCellsZ(); k++) {
+    for (int j = 0; j < flowField.getCellsY(); j++) {
+      for (int i = 0; i < flowField.getCellsX(); i++) {
+        RealType* velocity = flowField.getVelocity().getVector(i, j, k);
+        velocity[0]        = 1.0 + 2.0 * (meshsize.getPosX(i, j, k) + meshsize.getDx(i, j, k));
+        velocity[1]        = 3.0 * (meshsize.getPosY(i, j, k) + meshsize.getDy(i, j, k));
+        if constexpr (Dim == 3) {
+          velocity[2] = -1.0 + meshsize.getPosZ(i, j, k) + meshsize.getDz(i, j, k);
+        }
+      }
+    }
+  }
+
+  ParticleSimulation<Dim> particleSimulation(parameters, flowField);
+  particleSimulation.initializeParticles();
+  particleSimulation.advectParticles(0.0);
+
+  const ParticleContainer<Dim>& particles = particleSimulation.getParticles();
+  REQUIRE(particles.size() > 0);
+  for (int p = 0; p < particles.size(); p++) {
+    REQUIRE(std::abs(particles.getVelocities(0)[p] - (1.0 + 2.0 * particles.getPositions(0)[p])) < TOLERANCE);
+    REQUIRE(std::abs(particles.getVelocities(1)[p] - 3.0 * particles.getPositions(1)[p]) < TOLERANCE);
+    if constexpr (Dim == 3) {
+      REQUIRE(std::abs(particles.getVelocities(2)[p] - (-1.0 + particles.getPositions(2)[p])) < TOLERANCE);
+    }
+  }
+}
+
+TEST_CASE("Test particle velocity interpolation", "[single-file]") {
+  spdlog::info("Testing particle velocity interpolation");
+
+  checkInterpolation<2>();
+  checkInterpolation<3>();
+
+  spdlog::info("Test for particle velocity interpolation completed successfully");
+}
+
+TEST_CASE("Test particle reflection at obstacles", "[single-file]") {
+  spdlog::info("Testing particle reflection at obstacles");
+
+  // Backward facing step covering the lower left quarter of the channel, flagged like in the simulation
+  Parameters parameters;
+  setUpChannel(parameters, 2, 16);
+  parameters.bfStep.xRatio = 0.5;
+  parameters.bfStep.yRatio = 0.5;
+  FlowField                   flowField(parameters);
+  Stencils::BFStepInitStencil stencil(parameters);
+  FieldIterator<FlowField>    iterator(flowField, parameters, stencil, 0, 1);
+  iterator.iterate();
+
+  // The flow pushes the particles seeded above the step down onto it
+  for (int j = 0; j < flowField.getCellsY(); j++) {
+    for (int i = 0; i < flowField.getCellsX(); i++) {
+      RealType* velocity = flowField.getVelocity().getVector(i, j);
+      velocity[0]        = 0.0;
+      velocity[1]        = -1.0;
+    }
+  }
+
+  ParticleSimulation<2> particleSimulation(parameters, flowField);
+  particleSimulation.initializeParticles();
+  REQUIRE(particleSimulation.getNumberOfParticles() == 16);
+
+  const ParticleContainer<2>& particles = particleSimulation.getParticles();
+  for (int step = 0; step < 200; step++) {
+    particleSimulation.advectParticles(0.005);
+    for (int p = 0; p < particles.size(); p++) {
+      const int i = particles.getIndices(0)[p];
+      const int j = particles.getIndices(1)[p];
+      REQUIRE((flowField.getFlags().getValue(i, j) & OBSTACLE_SELF) == 0);
+      REQUIRE(particles.getPositions(1)[p] >= 0.5);
+    }
+  }
+
+  spdlog::info("Test for particle reflection at obstacles completed successfully");
+}
+
+TEST_CASE("Test particle injection", "[single-file]") {
+  spdlog::info("Testing particle injection");
+
+  // A plane of 16 * 16 particles at the inlet of a 3D channel, each of them inside the cell it is assigned to
+  Parameters parameters;
+  setUpChannel(parameters, 3, 16);
+  FlowField flowField(parameters);
+
+  ParticleSimulation<3> particleSimulation(parameters, flowField);
+  for (int injection = 0; injection < 2; injection++) {
+    particleSimulation.initializeParticles();
+  }
+  const ParticleContainer<3>& particles = particleSimulation.getParticles();
+  REQUIRE(particles.size() == 2 * 16 * 16);
+  for (int p = 0; p < particles.size(); p++) {
+    for (int d = 0; d < 3; d++) {
+      const int      index = particles.getIndices(d)[p];
+      const RealType start = (d == 0)   ? parameters.meshsize->getPosX(index, 0, 0)
+                             : (d == 1) ? parameters.meshsize->getPosY(0, index, 0)
+                                        : parameters.meshsize->getPosZ(0, 0, index);
+      REQUIRE(start <= particles.getPositions(d)[p]);
+      REQUIRE(particles.getPositions(d)[p] < start + 1.0 / parameters.parallel.localSize[d]);
+    }
+    REQUIRE(particles.getInjections()[p] == p / (16 * 16));
+  }
+
+  spdlog::info("Test for particle injection completed successfully");
+}
+
+TEST_CASE("Test particle budget", "[single-file]") {
+  spdlog::info("Testing particle budget");
+
+  // Every injection seeds 8 particles, of which the budget holds 12
+  Parameters parameters;
+  setUpChannel(parameters, 2, 8);
+  parameters.particles.maxParticles = 12;
+  FlowField flowField(parameters);
+
+  // Injections which exceed the budget are skipped
+  ParticleSimulation<2> skipping(parameters, flowField);
+  for (int injection = 0; injection < 3; injection++) {
+    skipping.initializeParticles();
+  }
+  REQUIRE(skipping.getNumberOfParticles() == 8);
+
+  // Injections which exceed the budget replace the oldest particles
+  parameters.particles.dropOldest = true;
+  ParticleSimulation<2> dropping(parameters, flowField);
+  for (int injection = 0; injection < 3; injection++) {
+    dropping.initializeParticles();
+  }
+  const ParticleContainer<2>& particles = dropping.getParticles();
+  REQUIRE(particles.size() == 12);
+  REQUIRE(std::count(particles.getInjections(), particles.getInjections() + particles.size(), 1) == 4);
+  REQUIRE(std::count(particles.getInjections(), particles.getInjections() + particles.size(), 2) == 8);
+
+  spdlog::info("Test for particle budget completed successfully");
+}
+
+TEST_CASE("Test particle trajectories", "[single-file]") {
+  spdlog::info("Testing particle trajectories");
+
+  Parameters parameters;
+  setUpChannel(parameters, 2, 8);
+  parameters.vtk.prefix                 = "ParticleTrajectoryTest";
+  parameters.particles.trajectoryStride = 2;
+  std::filesystem::create_directories("Output/" + parameters.vtk.prefix);
+  FlowField flowField(parameters);
+  fillVelocity(flowField);
+
+  // Every particle of every injection has its own identifier
+  {
+    ParticleSimulation<2> particleSimulation(parameters, flowField);
+    for (int injection = 0; injection < 3; injection++) {
+      particleSimulation.initializeParticles();
+    }
+    const ParticleContainer<2>& particles = particleSimulation.getParticles();
+    std::vector<std::int64_t>   ids(particles.getIds(), particles.getIds() + particles.size());
+    std::sort(ids.begin(), ids.end());
+    REQUIRE(ids.size() == 3 * 8);
+    for (std::size_t n = 0; n < ids.size(); n++) {
+      REQUIRE(ids[n] == static_cast<std::int64_t>(n));
+    }
+
+    for (int step = 0; step <= 4; step++) {
+      particleSimulation.recordTrajectories(step, 0.01 * step);
+      particleSimulation.advectParticles(0.01);
+    }
+  }
+
+  // Time steps 0, 2 and 4 are recorded
+  const auto pathlines = ParticleTrajectory::readPathlines(
+    {ParticleTrajectory::getFileName(parameters.vtk.prefix, parameters.parallel.rank)}
+  );
+  REQUIRE(pathlines.size() == 3 * 8);
+  for (const auto& [id, pathline] : pathlines) {
+    REQUIRE(pathline.size() == 3);
+    for (std::size_t n = 0; n < pathline.size(); n++) {
+      REQUIRE(pathline[n].id == id);
+      REQUIRE(pathline[n].time == 0.02 * n);
+      REQUIRE(pathline[n].position[2] == 0.0);
+    }
+    REQUIRE(pathline[2].position[0] > pathline[0].position[0]);
+  }
+
+  // A restarted run cuts the log off at the checkpoint and continues it
+  const std::string fileName = ParticleTrajectory::getFileName(parameters.vtk.prefix, parameters.parallel.rank);
+  ParticleTrajectory::truncate(fileName, 0.02);
+  REQUIRE(ParticleTrajectory::readPathlines({fileName}).begin()->second.size() == 1);
+  parameters.particles.restart = parameters.vtk.prefix;
+  {
+    ParticleSimulation<2> particleSimulation(parameters, flowField);
+    particleSimulation.initializeParticles();
+    particleSimulation.recordTrajectories(2, 0.02);
+  }
+  const auto continued = ParticleTrajectory::readPathlines({fileName});
+  REQUIRE(continued.begin()->second.size() == 2);
+  REQUIRE(continued.begin()->second[1].time == 0.02);
+
+  spdlog::info("Test for particle trajectories completed successfully");
+}
+
+// Reads the next array of the appended data of a VTK XML file
+template <class T>
+static std::vector<T> readAppendedArray(std::istream& file) {
+  std::uint64_t bytes;
+  file.read(reinterpret_cast<char*>(&bytes), sizeof(bytes));
+  std::vector<T> values(bytes / sizeof(T));
+  file.read(reinterpret_cast<char*>(values.data()), bytes);
+  return values;
+}
+
+TEST_CASE("Test binary particle output", "[single-file]") {
+  spdlog::info("Testing binary particle output");
+
+  Parameters parameters;
+  setUpChannel(parameters, 2, 8);
+  parameters.vtk.prefix = "ParticlePlotTest";
+  std::filesystem::create_directories("Output/" + parameters.vtk.prefix);
+  FlowField flowField(parameters);
+  fillVelocity(flowField);
+
+  ParticleSimulation<2> particleSimulation(parameters, flowField);
+  particleSimulation.initializeParticles();
+  particleSimulation.advectParticles(0.01);
+  particleSimulation.plot(3, 0.01);
+
+  // The appended data starts behind the underscore and holds velocities, identifiers and points
+  std::ifstream file("Output/ParticlePlotTest/ParticlePlotTestparticles.0.3.vtp", std::ios::binary);
+  REQUIRE(file);
+  std::string line;
+  while (std::getline(file, line) && line.find("<AppendedData") == std::string::npos) {}
+  REQUIRE(file.get() == '_');
+  const std::vector<RealType>     velocities = readAppendedArray<RealType>(file);
+  const std::vector<std::int64_t> ids        = readAppendedArray<std::int64_t>(file);
+  const std::vector<RealType>     positions  = readAppendedArray<RealType>(file);
+  REQUIRE(file);
+
+  const ParticleContainer<2>& particles = particleSimulation.getParticles();
+  REQUIRE(ids.size() == 8);
+  REQUIRE(velocities.size() == 3 * 8);
+  REQUIRE(positions.size() == 3 * 8);
+  for (int p = 0; p < particles.size(); p++) {
+    REQUIRE(ids[p] == particles.getIds()[p]);
+    for (int d = 0; d < 2; d++) {
+      REQUIRE(velocities[3 * p + d] == particles.getVelocities(d)[p]);
+      REQUIRE(positions[3 * p + d] == particles.getPositions(d)[p]);
+    }
+    REQUIRE(velocities[3 * p + 2] == 0.0);
+    REQUIRE(positions[3 * p + 2] == 0.0);
+  }
+
+  // The index of rank 0 references the file of every rank
+  std::ifstream      index("Output/ParticlePlotTest/ParticlePlotTestparticles.3.pvtp");
+  std::ostringstream content;
+  content << index.rdbuf();
+  REQUIRE(content.str().find("<Piece Source=\"ParticlePlotTestparticles.0.3.vtp\"/>") != std::string::npos);
+
+  spdlog::info("Test for binary particle output completed successfully");
+}
+
+TEST_CASE("Test particle deposit", "[single-file]") {
+  spdlog::info("Testing particle deposit");
+
+  for (const std::string deposit : {"ngp", "cic"}) {
+    Parameters parameters;
+    setUpChannel(parameters, 2, 8);
+    parameters.particles.deposit = deposit;
+    FlowField flowField(parameters);
+    fillVelocity(flowField);
+
+    ParticleSimulation<2> particleSimulation(parameters, flowField);
+    particleSimulation.initializeParticles();
+    for (int step = 0; step < 3; step++) {
+      particleSimulation.advectParticles(0.01);
+    }
+    particleSimulation.depositParticles();
+
+    // Both schemes conserve the number of particles within the inner cells, cloud in cell also their centre on a
+    // uniform mesh
+    const ParticleContainer<2>& particles  = particleSimulation.getParticles();
+    const Meshsize&             meshsize   = *parameters.meshsize;
+    RealType                    total      = 0.0;
+    RealType                    moments[2] = {0.0, 0.0};
+    for (int j = 2; j < flowField.getCellsY() - 1; j++) {
+      for (int i = 2; i < flowField.getCellsX() - 1; i++) {
+        const RealType amount = flowField.getConcentration().getScalar(i, j) * meshsize.getDx(i, j)
+                                * meshsize.getDy(i, j);
+        total += amount;
+        moments[0] += amount * (meshsize.getPosX(i, j) + 0.5 * meshsize.getDx(i, j));
+        moments[1] += amount * (meshsize.getPosY(i, j) + 0.5 * meshsize.getDy(i, j));
+      }
+    }
+    REQUIRE(std::abs(total - particles.size()) < 1e-10);
+    if (deposit == "cic") {
+      for (int d = 0; d < 2; d++) {
+        const RealType centre = std::accumulate(
+          particles.getPositions(d), particles.getPositions(d) + particles.size(), RealType(0.0)
+        );
+        REQUIRE(std::abs(moments[d] - centre) < 1e-10);
+      }
+    }
+  }
+
+  Parameters parameters;
+  setUpChannel(parameters, 2, 8);
+  parameters.particles.deposit = "tsc";
+  FlowField flowField(parameters);
+  REQUIRE_THROWS_AS(ParticleSimulation<2>(parameters, flowField), std::runtime_error);
+
+  spdlog::info("Test for particle deposit completed successfully");
+}
+
+TEST_CASE("Test particle statistics", "[single-file]") {
+  spdlog::info("Testing particle statistics");
+
+  // The flow pushes the particles onto the bottom wall of a 2D channel, where they are reflected
+  Parameters parameters;
+  setUpChannel(parameters, 2, 8);
+  parameters.particles.statistics = "residence, means,hits";
+  FlowField flowField(parameters);
+  for (int j = 0; j < flowField.getCellsY(); j++) {
+    for (int i = 0; i < flowField.getCellsX(); i++) {
+      RealType* velocity = flowField.getVelocity().getVector(i, j);
+      velocity[0]        = 0.0;
+      velocity[1]        = -1.0;
+    }
+  }
+
+  ParticleSimulation<2> particleSimulation(parameters, flowField);
+  particleSimulation.initializeParticles();
+  const int      steps = 200;
+  const RealType dt    = 0.005;
+  for (int step = 0; step < steps; step++) {
+    particleSimulation.advectParticles(dt);
+  }
+
+  const ParticleStatistics::Statistics& statistics = particleSimulation.getStatistics();
+  REQUIRE(statistics.size() == 3);
+  const std::vector<double>& means = statistics[1]->getSums();
+  REQUIRE(means[0] == 8 * steps);
+  REQUIRE(std::abs(means[1] / means[0] - 1.0) < 1e-10);
+  REQUIRE(std::abs(means[2] / means[0] - 0.5 * (steps + 1) * dt) < 1e-10);
+  const std::vector<double>& hits = statistics[2]->getSums();
+  REQUIRE(hits[ParticleStatistics::BOTTOM] >= 8);
+  REQUIRE(hits[ParticleStatistics::TOP] == 0);
+  REQUIRE(hits[ParticleStatistics::OBSTACLES] == 0);
+
+  // Residence times beyond the last bin are counted in it
+  ParticleStatistics::Statistics histogram;
+  histogram.push_back(std::make_unique<ParticleStatistics::ResidenceTimeHistogram>(0.5, 4));
+  for (const RealType residenceTime : {0.1, 0.7, 100.0}) {
+    histogram[0]->exit(residenceTime);
+  }
+  std::stringstream json;
+  ParticleStatistics::write(json, histogram, histogram[0]->getSums(), 3, 0.25);
+  REQUIRE(
+    json.str() == "{\"timeStep\": 3, \"time\": 0.25, \"residence\": {\"binWidth\": 0.5, \"counts\": [1, 1, 0, 1]}}\n"
+  );
+
+  parameters.particles.statistics = "hits,rdf";
+  REQUIRE_THROWS_AS(ParticleSimulation<2>(parameters, flowField), std::runtime_error);
+
+  spdlog::info("Test for particle statistics completed successfully");
+}
+
+// Positions after advecting the particles of a 2D channel through the field u = 0.5 + x for 0.4 time units
+static std::vector<RealType> advectThroughLinearField(int integratorOrder, RealType cfl) {
+  Parameters parameters;
+  setUpChannel(parameters, 2, 8);
+  parameters.particles.integratorOrder = integratorOrder;
+  parameters.particles.cfl             = cfl;
+  FlowField flowField(parameters);
+  for (int j = 0; j < flowField.getCellsY(); j++) {
+    for (int i = 0; i < flowField.getCellsX(); i++) {
+      RealType* velocity = flowField.getVelocity().getVector(i, j);
+      velocity[0]        = 0.5 + parameters.meshsize->getPosX(i, j) + parameters.meshsize->getDx(i, j);
+      velocity[1]        = 0.0;
+    }
+  }
+
+  ParticleSimulation<2> particleSimulation(parameters, flowField);
+  particleSimulation.initializeParticles();
+  const ParticleContainer<2>& particles = particleSimulation.getParticles();
+  std::vector<RealType>       positions(particles.getPositions(0), particles.getPositions(0) + particles.size());
+  for (int step = 0; step < 2; step++) {
+    particleSimulation.advectParticles(0.2);
+  }
+
+  // Difference to the exact solution x(t) = (x0 + 0.5) * exp(t) - 0.5
+  REQUIRE(particles.size() == static_cast<int>(positions.size()));
+  for (int p = 0; p < particles.size(); p++) {
+    positions[p] = particles.getPositions(0)[p] - ((positions[p] + 0.5) * std::exp(0.4) - 0.5);
+  }
+  return positions;
+}
+
+TEST_CASE("Test particle integrators", "[single-file]") {
+  spdlog::info("Testing particle integrators");
+
+  // The classical Runge-Kutta method with sub-steps follows the exponential path far closer than the Euler method
+  const std::vector<RealType> euler       = advectThroughLinearField(1, 0.0);
+  const std::vector<RealType> rungeKutta  = advectThroughLinearField(4, 0.5);
+  const std::vector<RealType> subStepping = advectThroughLinearField(1, 0.5);
+  for (std::size_t p = 0; p < euler.size(); p++) {
+    REQUIRE(std::abs(euler[p]) > 1e-3);
+    REQUIRE(std::abs(subStepping[p]) < std::abs(euler[p]));
+    REQUIRE(std::abs(rungeKutta[p]) < 1e-6);
+  }
+
+  // Heun's method sees the field of the previous time step at the beginning and the current one at the end
+  Parameters parameters;
+  setUpChannel(parameters, 2, 8);
+  parameters.particles.integratorOrder = 2;
+  FlowField             flowField(parameters);
+  ParticleSimulation<2> particleSimulation(parameters, flowField);
+  particleSimulation.initializeParticles();
+  const ParticleContainer<2>& particles = particleSimulation.getParticles();
+  const std::vector<RealType> start(particles.getPositions(0), particles.getPositions(0) + particles.size());
+  for (int j = 0; j < flowField.getCellsY(); j++) {
+    for (int i = 0; i < flowField.getCellsX(); i++) {
+      flowField.getVelocity().getVector(i, j)[0] = 2.0;
+    }
+  }
+  particleSimulation.advectParticles(0.1);
+  for (int p = 0; p < particles.size(); p++) {
+    REQUIRE(std::abs(particles.getPositions(0)[p] - (start[p] + 0.1)) < TOLERANCE);
+  }
+
+  REQUIRE_THROWS_AS(
+    [&]() {
+      parameters.particles.integratorOrder = 3;
+      ParticleSimulation<2> invalid(parameters, flowField);
+    }(),
+    std::runtime_error
+  );
+
+  spdlog::info("Test for particle integrators completed successfully");
+}
+
+template <int Dim>
+static void benchmarkAdvection(int particleCount) {
+  Parameters parameters;
+  setUpChannel(parameters, Dim, particleCount);
+  FlowField flowField(parameters);
+  fillVelocity(flowField);
+
+  ParticleSimulation<Dim> particleSimulation(parameters, flowField);
+  particleSimulation.initializeParticles();
+  spdlog::info("Advecting {} particles in {}D", particleSimulation.getNumberOfParticles(), Dim);
+
+#ifdef _OPENMP
+  const int maxThreads = omp_get_max_threads();
+#else
+  const int maxThreads = 1;
+#endif
+  for (int threads = 1; threads <= maxThreads; threads *= 2) {
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+    // Particles stay in place, so every sample does the same work
+    BENCHMARK(std::to_string(Dim) + "D, " + std::to_string(threads) + " threads") {
+      particleSimulation.advectParticles(0.0);
+      return particleSimulation.getNumberOfParticles();
+    };
+  }
+#ifdef _OPENMP
+  omp_set_num_threads(maxThreads);
+#endif
+}
+
+// Run with: OMP_NUM_THREADS=<threads> ./ParticleSimulationTest "[benchmark]"
+TEST_CASE("Benchmark threaded particle advection", "[.][benchmark]") {
+  // 2D: 2^16 particles along y, 3D: 256 * 256 particles in the yz-plane
+  benchmarkAdvection<2>(1 << 16);
+  benchmarkAdvection<3>(256);
+}
+
+// Run with: ./ParticleSimulationTest "[benchmark]"
+TEST_CASE("Benchmark cell-sorted particle advection", "[.][benchmark]") {
+  // Dense injection into a 3D channel: every injection appends a plane of particles, which the shear spreads over
+  // the channel, so that particles close in memory end up in unrelated cells
+  Parameters parameters;
+  setUpChannel(parameters, 3, 128);
+  FlowField flowField(parameters);
+  fillVelocity(flowField);
+
+  ParticleSimulation<3> particleSimulation(parameters, flowField);
+  for (int injection = 0; injection < 16; injection++) {
+    particleSimulation.initializeParticles();
+    for (int step = 0; step < 4; step++) {
+      particleSimulation.advectParticles(0.01);
+    }
+  }
+  spdlog::info("Advecting {} particles per sample", particleSimulation.getNumberOfParticles());
+
+  // Particles stay in place, so every sample does the same work
+  BENCHMARK("Injection order") {
+    particleSimulation.advectParticles(0.0);
+    return particleSimulation.getNumberOfParticles();
+  };
+
+  parameters.particles.sortInterval = 1;
+  particleSimulation.advectParticles(0.0);
+  parameters.particles.sortInterval = 0;
+  BENCHMARK("Cell order") {
+    particleSimulation.advectParticles(0.0);
+    return particleSimulation.getNumberOfParticles();
+  };
+}
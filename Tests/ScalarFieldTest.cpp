@@ -47,4 +47,40 @@ TEST_CASE("Test scalar field", "[single-file]") {
   }
 
   spdlog::info("Test for scalar fields completed successfully");
-}
\ No newline at end of file
+}
+
+TEST_CASE("Test field storage layout", "[single-file]") {
+  spdlog::info("Testing field storage layout");
+
+  // Checks that the given accessor of a field agrees with its data array, pitch and size
+  const auto checkLayout = [](auto& field, const auto& position, int components) {
+    REQUIRE(reinterpret_cast<std::uintptr_t>(field.getData()) % CACHE_LINE_SIZE == 0);
+    REQUIRE(field.getPitch() >= field.getNx());
+    REQUIRE(field.getSize() == components * field.getPitch() * field.getNy() * field.getNz());
+
+    for (int k = 0; k < field.getNz(); k++) {
+      for (int j = 0; j < field.getNy(); j++) {
+        const std::ptrdiff_t row = components * (j + k * field.getNy()) * field.getPitch();
+        for (int i = 0; i < field.getNx(); i++) {
+          REQUIRE(position(i, j, k) - field.getData() == row + components * i);
+        }
+#ifdef ENABLE_FIELD_PADDING
+        REQUIRE(reinterpret_cast<std::uintptr_t>(position(0, j, k)) % CACHE_LINE_SIZE == 0);
+#endif
+      }
+    }
+  };
+
+  // Fields of 8, 61 and 64 cells with their ghost layers
+  for (const int size : {11, 64, 67}) {
+    ScalarField    scalarField(size, size - 1, 5);
+    VectorField    vectorField(size, size - 1, 5);
+    IntScalarField intField(size, size - 1, 5);
+
+    checkLayout(scalarField, [&](int i, int j, int k) { return &scalarField.getScalar(i, j, k); }, 1);
+    checkLayout(vectorField, [&](int i, int j, int k) { return vectorField.getVector(i, j, k); }, 3);
+    checkLayout(intField, [&](int i, int j, int k) { return &intField.getValue(i, j, k); }, 1);
+  }
+
+  spdlog::info("Test for field storage layout completed successfully");
+}
@@ -0,0 +1,75 @@
+#include "StdAfx.hpp"
+
+#include "ParticleTrajectory.hpp"
+
+// Stitches the particle trajectory logs of all ranks of a run into pathlines, written as one VTK file with a polyline
+// per particle. Usage: NS-EOF-Pathlines <output.vtk> <log>...
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    spdlog::error("Usage: {} <output.vtk> <trajectory log>...", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const std::vector<std::string> fileNames(argv + 2, argv + argc);
+
+  std::map<std::int64_t, ParticleTrajectory::Pathline> pathlines;
+  try {
+    pathlines = ParticleTrajectory::readPathlines(fileNames);
+  } catch (const std::exception& exception) {
+    spdlog::error("{}", exception.what());
+    return EXIT_FAILURE;
+  }
+
+  std::size_t numberOfPoints = 0;
+  for (const auto& [id, pathline] : pathlines) {
+    numberOfPoints += pathline.size();
+  }
+
+  std::ofstream ofile(argv[1]);
+  if (!ofile) {
+    spdlog::error("Cannot open {}", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  ofile << "# vtk DataFile Version 2.0" << std::endl << "NS-EOF" << std::endl << "ASCII" << std::endl << std::endl;
+  ofile << "DATASET POLYDATA" << std::endl << "POINTS " << numberOfPoints << " float" << std::endl;
+  for (const auto& [id, pathline] : pathlines) {
+    for (const ParticleTrajectory::Record& record : pathline) {
+      ofile << record.position[0] << " " << record.position[1] << " " << record.position[2] << std::endl;
+    }
+  }
+
+  // One polyline per particle, through its points in the order of time
+  ofile << std::endl << "LINES " << pathlines.size() << " " << pathlines.size() + numberOfPoints << std::endl;
+  std::size_t point = 0;
+  for (const auto& [id, pathline] : pathlines) {
+    ofile << pathline.size();
+    for (std::size_t n = 0; n < pathline.size(); n++) {
+      ofile << " " << point++;
+    }
+    ofile << std::endl;
+  }
+
+  ofile << std::endl << "CELL_DATA " << pathlines.size() << std::endl;
+  ofile << "SCALARS id double 1" << std::endl << "LOOKUP_TABLE default" << std::endl;
+  for (const auto& [id, pathline] : pathlines) {
+    ofile << id << std::endl;
+  }
+
+  ofile << std::endl << "POINT_DATA " << numberOfPoints << std::endl;
+  ofile << "SCALARS time float 1" << std::endl << "LOOKUP_TABLE default" << std::endl;
+  for (const auto& [id, pathline] : pathlines) {
+    for (const ParticleTrajectory::Record& record : pathline) {
+      ofile << record.time << std::endl;
+    }
+  }
+  ofile << "VECTORS velocity float" << std::endl;
+  for (const auto& [id, pathline] : pathlines) {
+    for (const ParticleTrajectory::Record& record : pathline) {
+      ofile << record.velocity[0] << " " << record.velocity[1] << " " << record.velocity[2] << std::endl;
+    }
+  }
+
+  spdlog::info("Wrote {} pathlines with {} points to {}", pathlines.size(), numberOfPoints, argv[1]);
+  return EXIT_SUCCESS;
+}